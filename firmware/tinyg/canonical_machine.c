@@ -53,6 +53,9 @@
  *		planner.h for details
  *
  *	  - mp_queue_command() stores the callback and the args in a planner buffer.
+ *		The machine comes to a stop at the buffer. Commands that don't need a 
+ *		stop (coolant, spindle speed, tool select) use mp_queue_inline_command()
+ *		instead, which the planner plans straight through.
  *
  *	  - When planner execution reaches the buffer is tectures the callback w/ the 
  *		args.  Take careful note that the callback executes under an interrupt, 
@@ -156,6 +159,7 @@ uint8_t cm_get_model_coord_system() { return gm.coord_system;}
 uint8_t cm_get_model_units_mode() { return gm.units_mode;}
 uint8_t cm_get_model_select_plane() { return gm.select_plane;}
 uint8_t cm_get_model_path_control() { return gm.path_control;}
+float cm_get_model_path_tolerance() { return gm.path_tolerance;}
 uint8_t cm_get_model_distance_mode() { return gm.distance_mode;}
 uint8_t cm_get_model_inverse_feed_rate_mode() { return gm.inverse_feed_rate_mode;}
 uint8_t cm_get_model_spindle_mode() { return gm.spindle_mode;} 
@@ -479,7 +483,6 @@ static float _get_move_times(float *min_time)
 	float abc_time=0;	// coordinated move rotary part at req feed rate
 	float max_time=0;	// time required for the rate-limiting axis
 	float tmp_time=0;	// used in computation
-	*min_time = 1234567;// arbitrarily large number
 
 	// compute times for feed motion
 	if (gm.motion_mode == MOTION_MODE_STRAIGHT_FEED) {
@@ -503,8 +506,8 @@ static float _get_move_times(float *min_time)
 			tmp_time = fabs(gm.target[i] - gm.position[i]) / cfg.a[i].velocity_max;
 		}
 		max_time = max(max_time, tmp_time);
-		*min_time = min(*min_time, tmp_time);
 	}
+	*min_time = max_time;
 	return (max4(inv_time, max_time, xyz_time, abc_time));
 }
 
@@ -545,16 +548,19 @@ void cm_init()
 	cm_set_units_mode(cfg.units_mode);
 	cm_set_coord_system(cfg.coord_system);
 	cm_select_plane(cfg.select_plane);
-	cm_set_path_control(cfg.path_control);
+	cm_set_path_control(cfg.path_control, 0);
 	cm_set_distance_mode(cfg.distance_mode);
 
 	// never start a machine in a motion mode	
 	gm.motion_mode = MOTION_MODE_CANCEL_MOTION_MODE;
+	gm.feed_rate_override_factor = 1;	// overrides start out at 100% when enabled
+	gm.traverse_override_factor = 1;
 
 	// reset request flags
 	cm.feedhold_requested = false;
 	cm.queue_flush_requested = false;
 	cm.cycle_start_requested = false;
+	cm.feed_override_requested = FEED_OVERRIDE_NO_REQUEST;
 
 	// signal that the machine is ready for action
 	cm.machine_state = MACHINE_READY;	
@@ -762,8 +768,9 @@ stat_t cm_straight_traverse(float target[], float flags[])
 	if (vector_equal(gm.target, gm.position)) { return (STAT_OK); }
 
 	cm_cycle_start();							// required for homing & other cycles
+	float minutes = _get_move_times(&gm.min_time);	// sets min_time before it is passed on
 	stat_t status = MP_LINE(gm.target, 
-							_get_move_times(&gm.min_time), 
+							minutes, 
 							cm_get_coord_offset_vector(gm.work_offset), 
 							gm.min_time);
 	cm_set_gcode_model_endpoint_position(status);
@@ -845,11 +852,19 @@ stat_t cm_set_inverse_feed_rate_mode(uint8_t mode)
 
 /*
  * cm_set_path_control() - G61, G61.1, G64
+ *
+ *	G64 P<tol> lets the planner cut corners between G1 lines by up to tol 
+ *	(see _blend_corner() in plan_line.c). G64 without P, or with P0, drives
+ *	through every vertex as before. The tolerance is in the current units.
  */
 
-stat_t cm_set_path_control(uint8_t mode)
+stat_t cm_set_path_control(uint8_t mode, float tolerance)
 {
 	gm.path_control = mode;
+	gm.path_tolerance = 0;
+	if ((mode == PATH_CONTINUOUS) && (tolerance > 0)) {
+		gm.path_tolerance = _to_millimeters(tolerance);
+	}
 	return (STAT_OK);
 }
 
@@ -879,18 +894,13 @@ stat_t cm_straight_feed(float target[], float flags[])
 		return (STAT_GCODE_FEEDRATE_ERROR);
 	}
 
-	// Introduce a short dwell if the machine is not busy to enable the planning
-	// queue to begin to fill (avoids first block having to plan down to zero)
-//	if (st_isbusy() == false) {
-//		cm_dwell(PLANNER_STARTUP_DELAY_SECONDS);
-//	}
-
 	cm_set_target(target, flags);
 	if (vector_equal(gm.target, gm.position)) { return (STAT_OK); }
 
 	cm_cycle_start();						// required for homing & other cycles
+	float minutes = _get_move_times(&gm.min_time);	// sets min_time before it is passed on
 	stat_t status = MP_LINE(gm.target, 
-							 _get_move_times(&gm.min_time), 
+							 minutes, 
 							 cm_get_coord_offset_vector(gm.work_offset), 
 							 gm.min_time);
 
@@ -924,7 +934,7 @@ static void _exec_change_tool(uint8_t tool, float float_val)
 
 stat_t cm_select_tool(uint8_t tool)
 {
-	mp_queue_command(_exec_select_tool, tool, 0);
+	mp_queue_inline_command(_exec_select_tool, tool, 0);
 	return (STAT_OK);
 }
 static void _exec_select_tool(uint8_t tool, float float_val)
@@ -941,13 +951,13 @@ static void _exec_select_tool(uint8_t tool, float float_val)
 
 stat_t cm_mist_coolant_control(uint8_t mist_coolant)
 {
-	mp_queue_command(_exec_mist_coolant_control, mist_coolant,0);
+	mp_queue_inline_command(_exec_mist_coolant_control, mist_coolant,0);
 	return (STAT_OK);
 }
 
 stat_t cm_flood_coolant_control(uint8_t flood_coolant)
 {
-	mp_queue_command(_exec_flood_coolant_control, flood_coolant,0);
+	mp_queue_inline_command(_exec_flood_coolant_control, flood_coolant,0);
 	return (STAT_OK);
 }
 
@@ -990,6 +1000,8 @@ stat_t cm_override_enables(uint8_t flag)			// M48, M49
 	gm.feed_rate_override_enable = flag;
 	gm.traverse_override_enable = flag;
 	gm.spindle_override_enable = flag;
+	mp_feed_rate_override(gm.feed_rate_override_enable, gm.feed_rate_override_factor);
+	mp_traverse_override(gm.traverse_override_enable, gm.traverse_override_factor);
 	return (STAT_OK);
 }
 
@@ -1000,14 +1012,15 @@ stat_t cm_feed_rate_override_enable(uint8_t flag)	// M50
 	} else {
 		gm.feed_rate_override_enable = true;
 	}
+	mp_feed_rate_override(gm.feed_rate_override_enable, gm.feed_rate_override_factor);
 	return (STAT_OK);
 }
 
 stat_t cm_feed_rate_override_factor(uint8_t flag)	// M50.1
 {
 	gm.feed_rate_override_enable = flag;
-	gm.feed_rate_override_factor = gn.parameter;
-//	mp_feed_rate_override(flag, gn.parameter);		// replan the queue for new feed rate
+	gm.feed_rate_override_factor = (gf.parameter == true) ? gn.parameter : 1; // M50.1 without P is 100%
+	mp_feed_rate_override(flag, gm.feed_rate_override_factor);	// replan the queue for new feed rate
 	return (STAT_OK);
 }
 
@@ -1018,14 +1031,15 @@ stat_t cm_traverse_override_enable(uint8_t flag)	// M50.2
 	} else {
 		gm.traverse_override_enable = true;
 	}
+	mp_traverse_override(gm.traverse_override_enable, gm.traverse_override_factor);
 	return (STAT_OK);
 }
 
-stat_t cm_traverse_override_factor(uint8_t flag)	// M51
+stat_t cm_traverse_override_factor(uint8_t flag)	// M50.3
 {
 	gm.traverse_override_enable = flag;
-	gm.traverse_override_factor = gn.parameter;
-//	mp_feed_rate_override(flag, gn.parameter);		// replan the queue for new feed rate
+	gm.traverse_override_factor = (gf.parameter == true) ? gn.parameter : 1; // M50.3 without P is 100%
+	mp_traverse_override(flag, gm.traverse_override_factor);	// replan the queue for new traverse rate
 	return (STAT_OK);
 }
 
@@ -1085,6 +1099,7 @@ void cm_message(char *message)
  * cm_request_feedhold()
  * cm_request_queue_flush()
  * cm_request_cycle_start()
+ * cm_request_feed_override()
  * cm_feedhold_sequencing_callback() - process feedholds, cycle starts & queue flushes
  * cm_flush_planner() - Flush planner queue and correct model positions
  *
@@ -1107,11 +1122,16 @@ void cm_message(char *message)
  *		If a queue flush request is also present the queue flush should be done first
  *	A cycle start request received during a motion stop should be honored and 
  *		should start to run anything in the planner queue
+ *
+ *	A feed override request is honored in any state. It steps the feed rate override
+ *		(M50.1) up or down by FEED_OVERRIDE_STEP or back to 100% and enables it. 
+ *		The planner replans the running move once any feedhold is over.
  */
 
 void cm_request_feedhold(void) { cm.feedhold_requested = true; }
 void cm_request_queue_flush(void) { cm.queue_flush_requested = true; }
 void cm_request_cycle_start(void) { cm.cycle_start_requested = true; }
+void cm_request_feed_override(uint8_t request) { cm.feed_override_requested = request; }
 
 stat_t cm_feedhold_sequencing_callback()
 {
@@ -1129,12 +1149,27 @@ stat_t cm_feedhold_sequencing_callback()
 			cm_queue_flush();
 		}
 	}
-	if ((cm.cycle_start_requested == true) && (cm.queue_flush_requested == false)) {
+	if ((cm.cycle_start_requested == true) && (cm.queue_flush_requested == false) &&
+		((cm.motion_state != MOTION_HOLD) || (cm.hold_state == FEEDHOLD_HOLD))) {
 		cm.cycle_start_requested = false;
 		cm.hold_state = FEEDHOLD_END_HOLD;
 		cm_cycle_start();
 		mp_end_hold();
 	}
+	if (cm.feed_override_requested != FEED_OVERRIDE_NO_REQUEST) {
+		float factor = (gm.feed_rate_override_enable == true) ? gm.feed_rate_override_factor : 1;
+		if (cm.feed_override_requested == FEED_OVERRIDE_UP_REQUEST) {
+			factor += FEED_OVERRIDE_STEP;
+		} else if (cm.feed_override_requested == FEED_OVERRIDE_DOWN_REQUEST) {
+			factor -= FEED_OVERRIDE_STEP;
+		} else {
+			factor = 1;
+		}
+		cm.feed_override_requested = FEED_OVERRIDE_NO_REQUEST;
+		gm.feed_rate_override_enable = true;
+		gm.feed_rate_override_factor = min(max(factor, FEED_OVERRIDE_MIN), FEED_OVERRIDE_MAX);
+		mp_feed_rate_override(true, gm.feed_rate_override_factor);
+	}
 	return (STAT_OK);
 }
 
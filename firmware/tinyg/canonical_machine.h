@@ -44,6 +44,7 @@ typedef struct cmSingleton {		// struct to manage cm globals and cycles
 	uint8_t feedhold_requested;		// feedhold character has been received
 	uint8_t queue_flush_requested;	// queue flush character has been received
 	uint8_t cycle_start_requested;	// cycle start character has been received (flag to end feedhold)
+	uint8_t feed_override_requested;// feed override character has been received (see cmFeedOverrideRequest)
 	uint8_t homing_state;			// homing cycle sub-state machine
 	uint8_t homed[AXES];			// individual axis homing flags
 	uint8_t status_report_request;	// 0=no request, 1=timed request, 2=run one now 
@@ -115,6 +116,7 @@ typedef struct GCodeModel {				// Gcode dynamic model
 	uint8_t origin_offset_enable;		// G92 offsets enabled/disabled.  0=disabled, 1=enabled
 
 	uint8_t path_control;				// G61... EXACT_PATH, EXACT_STOP, CONTINUOUS
+	float path_tolerance;				// G64 P - corner blending tolerance in mm (0 = no blending)
 	uint8_t distance_mode;				// G91   0=use absolute coords(G90), 1=incremental movement
 
 	uint8_t tool;						// T value
@@ -278,6 +280,13 @@ enum cmFeedholdState {				// feedhold_state machine
 	FEEDHOLD_END_HOLD				// end hold (transient state to OFF)
 };
 
+enum cmFeedOverrideRequest {		// applies to cm.feed_override_requested
+	FEED_OVERRIDE_NO_REQUEST = 0,	// no feed override character received
+	FEED_OVERRIDE_RESET_REQUEST,	// return to the programmed feed rate (100%)
+	FEED_OVERRIDE_UP_REQUEST,		// raise the override by FEED_OVERRIDE_STEP
+	FEED_OVERRIDE_DOWN_REQUEST		// lower the override by FEED_OVERRIDE_STEP
+};
+
 enum cmHomingState {				// applies to cm.homing_state
 	HOMING_NOT_HOMED = 0,			// machine is not homed (0=false)
 	HOMING_HOMED = 1				// machine is homed (1=true)
@@ -450,6 +459,7 @@ uint8_t cm_get_model_coord_system(void);
 uint8_t cm_get_model_units_mode(void);
 uint8_t cm_get_model_select_plane(void);
 uint8_t cm_get_model_path_control(void);
+float cm_get_model_path_tolerance(void);
 uint8_t cm_get_model_distance_mode(void);
 uint8_t cm_get_model_inverse_feed_rate_mode(void);
 uint8_t cm_get_model_spindle_mode(void);
@@ -510,7 +520,7 @@ stat_t cm_resume_origin_offsets(void);				 			// G92.3
 stat_t cm_straight_traverse(float target[], float flags[]);
 stat_t cm_set_feed_rate(float feed_rate);						// F parameter
 stat_t cm_set_inverse_feed_rate_mode(uint8_t mode);				// True= inv mode
-stat_t cm_set_path_control(uint8_t mode);						// G61, G61.1, G64
+stat_t cm_set_path_control(uint8_t mode, float tolerance);		// G61, G61.1, G64 (P)
 stat_t cm_straight_feed(float target[], float flags[]);			// G1
 stat_t cm_arc_feed(float target[], float flags[], 				// G2, G3
 					float i, float j, float k, 
@@ -539,6 +549,7 @@ stat_t cm_feedhold_sequencing_callback(void);					// process feedhold, cycle sta
 void cm_request_feedhold(void);
 void cm_request_queue_flush(void);
 void cm_request_cycle_start(void);
+void cm_request_feed_override(uint8_t request);
 
 void cm_message(char *message);									// msg to console (e.g. Gcode comments)
 void cm_cycle_start(void);										// (no Gcode)
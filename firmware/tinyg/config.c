@@ -119,7 +119,7 @@ static void _print_corr(cmdObj_t *cmd);	// print coordinate offsets with rotary
 // helpers for generic functions
 static char *_get_format(const index_t i, char *format);
 static int8_t _get_motor(const index_t i);
-//static int8_t _get_axis(const index_t i);
+static int8_t _get_axis(const index_t i);
 static int8_t _get_pos_axis(const index_t i);
 static stat_t _text_parser(char *str, cmdObj_t *c);
 static stat_t _get_msg_helper(cmdObj_t *cmd, prog_char_ptr msg, uint8_t value);
@@ -149,6 +149,7 @@ static stat_t _run_boot(cmdObj_t *cmd);	// jump to the bootloader
 static stat_t _get_id(cmdObj_t *cmd);		// get device ID
 static stat_t _set_jv(cmdObj_t *cmd);		// set JSON verbosity
 static stat_t _get_qr(cmdObj_t *cmd);		// get a queue report (as data)
+static stat_t _get_qt(cmdObj_t *cmd);		// get the queue time horizon
 static stat_t _run_qf(cmdObj_t *cmd);		// execute a queue flush block
 static stat_t _get_er(cmdObj_t *cmd);		// invoke a bogus exception report for testing purposes
 static stat_t _get_rx(cmdObj_t *cmd);		// get bytes in RX buffer
@@ -187,6 +188,8 @@ static stat_t _set_tr(cmdObj_t *cmd);		// set motor travel per revolution
 static stat_t _set_mi(cmdObj_t *cmd);		// set microsteps
 static stat_t _set_po(cmdObj_t *cmd);		// set motor polarity
 static stat_t _set_pm(cmdObj_t *cmd);		// set motor power mode
+static stat_t _set_jm(cmdObj_t *cmd);		// set axis jerk max
+static stat_t _set_jd(cmdObj_t *cmd);		// set axis junction deviation
 
 static stat_t _set_sw(cmdObj_t *cmd);		// must run any time you change a switch setting
 static stat_t _get_am(cmdObj_t *cmd);		// get axis mode
@@ -330,8 +333,10 @@ static const char fmt_id[] PROGMEM = "[id]  TinyG ID%30s\n";
 static const char fmt_ja[] PROGMEM = "[ja]  junction acceleration%8.0f%S\n";
 static const char fmt_ml[] PROGMEM = "[ml]  min line segment%17.3f%S\n";
 static const char fmt_ma[] PROGMEM = "[ma]  min arc segment%18.3f%S\n";
+static const char fmt_mc[] PROGMEM = "[mc]  coalesce tolerance%15.3f%S\n";
 static const char fmt_ct[] PROGMEM = "[ct]  chordal tolerance%16.3f%S\n";
 static const char fmt_ms[] PROGMEM = "[ms]  min segment time%13.0f uSec\n";
+static const char fmt_mx[] PROGMEM = "[mx]  max segment time%13.0f uSec\n";
 static const char fmt_st[] PROGMEM = "[st]  switch type%18d [0=NO,1=NC]\n";
 static const char fmt_si[] PROGMEM = "[si]  status interval%14.0f ms\n";
 static const char fmt_ic[] PROGMEM = "[ic]  ignore CR or LF on RX%8d [0=off,1=CR,2=LF]\n";
@@ -346,6 +351,7 @@ static const char fmt_qv[] PROGMEM = "[qv]  queue report verbosity%7d [0=off,1=f
 static const char fmt_baud[] PROGMEM = "[baud] USB baud rate%15d [1=9600,2=19200,3=38400,4=57600,5=115200,6=230400]\n";
 
 static const char fmt_qr[] PROGMEM = "qr:%d\n";
+static const char fmt_qt[] PROGMEM = "qt:%d\n";
 static const char fmt_rx[] PROGMEM = "rx:%d\n";
 
 static const char fmt_md[] PROGMEM = "motors disabled\n";
@@ -493,6 +499,7 @@ const cfgItem_t cfgArray[] PROGMEM = {
 	// Reports, tests, help, and messages
 	{ "", "sr",  _f00, 0, fmt_nul, _print_sr,  _get_sr,  _set_sr , (float *)&tg.null, 0 },	// status report object
 	{ "", "qr",  _f00, 0, fmt_qr,  _print_int, _get_qr,  _set_nul, (float *)&tg.null, 0 },	// queue report setting
+	{ "", "qt",  _f00, 0, fmt_qt,  _print_int, _get_qt,  _set_nul, (float *)&tg.null, 0 },	// ms of motion queued
 	{ "", "qf",  _f00, 0, fmt_nul, _print_nul, _get_nul, _run_qf,  (float *)&tg.null, 0 },	// queue flush
 	{ "", "er",  _f00, 0, fmt_nul, _print_nul, _get_er,  _set_nul, (float *)&tg.null, 0 },	// invoke bogus exception report for testing
 	{ "", "rx",  _f00, 0, fmt_rx,  _print_int, _get_rx,  _set_nul, (float *)&tg.null, 0 },	// space in RX buffer
@@ -537,9 +544,9 @@ const cfgItem_t cfgArray[] PROGMEM = {
 	{ "x","xvm",_fip, 0, fmt_Xvm, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_X].velocity_max,	X_VELOCITY_MAX },
 	{ "x","xfr",_fip, 0, fmt_Xfr, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_X].feedrate_max,	X_FEEDRATE_MAX },
 	{ "x","xtm",_fip, 0, fmt_Xtm, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_X].travel_max,	X_TRAVEL_MAX },
-	{ "x","xjm",_fip, 0, fmt_Xjm, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_X].jerk_max,		X_JERK_MAX },
+	{ "x","xjm",_fip, 0, fmt_Xjm, _pr_ma_lin, _get_dbu, _set_jm, (float *)&cfg.a[AXIS_X].jerk_max,		X_JERK_MAX },
 	{ "x","xjh",_fip, 0, fmt_Xjh, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_X].jerk_homing,	X_JERK_HOMING },
-	{ "x","xjd",_fip, 4, fmt_Xjd, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_X].junction_dev,	X_JUNCTION_DEVIATION },
+	{ "x","xjd",_fip, 4, fmt_Xjd, _pr_ma_lin, _get_dbu, _set_jd, (float *)&cfg.a[AXIS_X].junction_dev,	X_JUNCTION_DEVIATION },
 	{ "x","xsn",_fip, 0, fmt_Xsn, _pr_ma_ui8, _get_ui8, _set_sw, (float *)&sw.mode[0],					X_SWITCH_MODE_MIN },
 	{ "x","xsx",_fip, 0, fmt_Xsx, _pr_ma_ui8, _get_ui8, _set_sw, (float *)&sw.mode[1],					X_SWITCH_MODE_MAX },
 	{ "x","xsv",_fip, 0, fmt_Xsv, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_X].search_velocity,X_SEARCH_VELOCITY },
@@ -551,9 +558,9 @@ const cfgItem_t cfgArray[] PROGMEM = {
 	{ "y","yvm",_fip, 0, fmt_Xvm, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_Y].velocity_max,	Y_VELOCITY_MAX },
 	{ "y","yfr",_fip, 0, fmt_Xfr, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_Y].feedrate_max,	Y_FEEDRATE_MAX },
 	{ "y","ytm",_fip, 0, fmt_Xtm, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_Y].travel_max,	Y_TRAVEL_MAX },
-	{ "y","yjm",_fip, 0, fmt_Xjm, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_Y].jerk_max,		Y_JERK_MAX },
+	{ "y","yjm",_fip, 0, fmt_Xjm, _pr_ma_lin, _get_dbu, _set_jm, (float *)&cfg.a[AXIS_Y].jerk_max,		Y_JERK_MAX },
 	{ "y","yjh",_fip, 0, fmt_Xjh, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_Y].jerk_homing,	Y_JERK_HOMING },
-	{ "y","yjd",_fip, 4, fmt_Xjd, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_Y].junction_dev,	Y_JUNCTION_DEVIATION },
+	{ "y","yjd",_fip, 4, fmt_Xjd, _pr_ma_lin, _get_dbu, _set_jd, (float *)&cfg.a[AXIS_Y].junction_dev,	Y_JUNCTION_DEVIATION },
 	{ "y","ysn",_fip, 0, fmt_Xsn, _pr_ma_ui8, _get_ui8, _set_sw, (float *)&sw.mode[2],					Y_SWITCH_MODE_MIN },
 	{ "y","ysx",_fip, 0, fmt_Xsx, _pr_ma_ui8, _get_ui8, _set_sw, (float *)&sw.mode[3],					Y_SWITCH_MODE_MAX },
 	{ "y","ysv",_fip, 0, fmt_Xsv, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_Y].search_velocity,Y_SEARCH_VELOCITY },
@@ -565,9 +572,9 @@ const cfgItem_t cfgArray[] PROGMEM = {
 	{ "z","zvm",_fip, 0, fmt_Xvm, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_Z].velocity_max,	Z_VELOCITY_MAX },
 	{ "z","zfr",_fip, 0, fmt_Xfr, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_Z].feedrate_max,	Z_FEEDRATE_MAX },
 	{ "z","ztm",_fip, 0, fmt_Xtm, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_Z].travel_max,	Z_TRAVEL_MAX },
-	{ "z","zjm",_fip, 0, fmt_Xjm, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_Z].jerk_max,		Z_JERK_MAX },
+	{ "z","zjm",_fip, 0, fmt_Xjm, _pr_ma_lin, _get_dbu, _set_jm, (float *)&cfg.a[AXIS_Z].jerk_max,		Z_JERK_MAX },
 	{ "z","zjh",_fip, 0, fmt_Xjh, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_Z].jerk_homing,	Z_JERK_HOMING },
-	{ "z","zjd",_fip, 4, fmt_Xjd, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_Z].junction_dev,	Z_JUNCTION_DEVIATION },
+	{ "z","zjd",_fip, 4, fmt_Xjd, _pr_ma_lin, _get_dbu, _set_jd, (float *)&cfg.a[AXIS_Z].junction_dev,	Z_JUNCTION_DEVIATION },
 	{ "z","zsn",_fip, 0, fmt_Xsn, _pr_ma_ui8, _get_ui8, _set_sw, (float *)&sw.mode[4],					Z_SWITCH_MODE_MIN },
 	{ "z","zsx",_fip, 0, fmt_Xsx, _pr_ma_ui8, _get_ui8, _set_sw, (float *)&sw.mode[5],					Z_SWITCH_MODE_MAX },
 	{ "z","zsv",_fip, 0, fmt_Xsv, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_Z].search_velocity,Z_SEARCH_VELOCITY },
@@ -579,9 +586,9 @@ const cfgItem_t cfgArray[] PROGMEM = {
 	{ "a","avm",_fip, 0, fmt_Xvm, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_A].velocity_max,	A_VELOCITY_MAX },
 	{ "a","afr",_fip, 0, fmt_Xfr, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_A].feedrate_max, 	A_FEEDRATE_MAX },
 	{ "a","atm",_fip, 0, fmt_Xtm, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_A].travel_max,	A_TRAVEL_MAX },
-	{ "a","ajm",_fip, 0, fmt_Xjm, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_A].jerk_max,		A_JERK_MAX },
+	{ "a","ajm",_fip, 0, fmt_Xjm, _pr_ma_rot, _get_dbl, _set_jm, (float *)&cfg.a[AXIS_A].jerk_max,		A_JERK_MAX },
 	{ "a","ajh",_fip, 0, fmt_Xjh, _pr_ma_lin, _get_dbu, _set_dbu,(float *)&cfg.a[AXIS_A].jerk_homing,	A_JERK_HOMING },
-	{ "a","ajd",_fip, 4, fmt_Xjd, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_A].junction_dev,	A_JUNCTION_DEVIATION },
+	{ "a","ajd",_fip, 4, fmt_Xjd, _pr_ma_rot, _get_dbl, _set_jd, (float *)&cfg.a[AXIS_A].junction_dev,	A_JUNCTION_DEVIATION },
 	{ "a","ara",_fip, 3, fmt_Xra, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_A].radius,		A_RADIUS},
 	{ "a","asn",_fip, 0, fmt_Xsn, _pr_ma_ui8, _get_ui8, _set_sw, (float *)&sw.mode[6],					A_SWITCH_MODE_MIN },
 	{ "a","asx",_fip, 0, fmt_Xsx, _pr_ma_ui8, _get_ui8, _set_sw, (float *)&sw.mode[7],					A_SWITCH_MODE_MAX },
@@ -594,16 +601,16 @@ const cfgItem_t cfgArray[] PROGMEM = {
 	{ "b","bvm",_fip, 0, fmt_Xvm, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_B].velocity_max,	B_VELOCITY_MAX },
 	{ "b","bfr",_fip, 0, fmt_Xfr, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_B].feedrate_max, 	B_FEEDRATE_MAX },
 	{ "b","btm",_fip, 0, fmt_Xtm, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_B].travel_max,	B_TRAVEL_MAX },
-	{ "b","bjm",_fip, 0, fmt_Xjm, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_B].jerk_max,		B_JERK_MAX },
-	{ "b","bjd",_fip, 0, fmt_Xjd, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_B].junction_dev,	B_JUNCTION_DEVIATION },
+	{ "b","bjm",_fip, 0, fmt_Xjm, _pr_ma_rot, _get_dbl, _set_jm, (float *)&cfg.a[AXIS_B].jerk_max,		B_JERK_MAX },
+	{ "b","bjd",_fip, 0, fmt_Xjd, _pr_ma_rot, _get_dbl, _set_jd, (float *)&cfg.a[AXIS_B].junction_dev,	B_JUNCTION_DEVIATION },
 	{ "b","bra",_fip, 3, fmt_Xra, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_B].radius,		B_RADIUS },
 
 	{ "c","cam",_fip, 0, fmt_Xam, _print_am,  _get_am,  _set_am, (float *)&cfg.a[AXIS_C].axis_mode,		C_AXIS_MODE },
 	{ "c","cvm",_fip, 0, fmt_Xvm, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_C].velocity_max,	C_VELOCITY_MAX },
 	{ "c","cfr",_fip, 0, fmt_Xfr, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_C].feedrate_max,	C_FEEDRATE_MAX },
 	{ "c","ctm",_fip, 0, fmt_Xtm, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_C].travel_max,	C_TRAVEL_MAX },
-	{ "c","cjm",_fip, 0, fmt_Xjm, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_C].jerk_max,		C_JERK_MAX },
-	{ "c","cjd",_fip, 0, fmt_Xjd, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_C].junction_dev,	C_JUNCTION_DEVIATION },
+	{ "c","cjm",_fip, 0, fmt_Xjm, _pr_ma_rot, _get_dbl, _set_jm, (float *)&cfg.a[AXIS_C].jerk_max,		C_JERK_MAX },
+	{ "c","cjd",_fip, 0, fmt_Xjd, _pr_ma_rot, _get_dbl, _set_jd, (float *)&cfg.a[AXIS_C].junction_dev,	C_JUNCTION_DEVIATION },
 	{ "c","cra",_fip, 3, fmt_Xra, _pr_ma_rot, _get_dbl, _set_dbl,(float *)&cfg.a[AXIS_C].radius,		C_RADIUS },
 
 	// PWM settings
@@ -715,8 +722,10 @@ const cfgItem_t cfgArray[] PROGMEM = {
 
 	// removed from system group as "hidden" parameters
 	{ "",   "ms",  _fip, 0, fmt_ms, _print_lin, _get_dbl, _set_dbl, (float *)&cfg.estd_segment_usec,	NOM_SEGMENT_USEC },
+	{ "",   "mx",  _fip, 0, fmt_mx, _print_lin, _get_dbl, _set_dbl, (float *)&cfg.max_segment_usec,	MAX_SEGMENT_USEC },
 	{ "",   "ml",  _fip, 4, fmt_ml, _print_lin, _get_dbu, _set_dbu, (float *)&cfg.min_segment_len,		MIN_LINE_LENGTH },
 	{ "",   "ma",  _fip, 4, fmt_ma, _print_lin, _get_dbu, _set_dbu, (float *)&cfg.arc_segment_len,		ARC_SEGMENT_LENGTH },
+	{ "",   "mc",  _fip, 4, fmt_mc, _print_lin, _get_dbu, _set_dbu, (float *)&cfg.coalesce_tolerance,	COALESCE_TOLERANCE },
 	{ "",   "qrh", _fip, 0, fmt_ui8,_print_ui8, _get_ui8, _set_ui8, (float *)&cfg.queue_report_hi_water,QR_HI_WATER },
 	{ "",   "qrl", _fip, 0, fmt_ui8,_print_ui8, _get_ui8, _set_ui8, (float *)&cfg.queue_report_lo_water,QR_LO_WATER },
 	{ "sys","net", _fip, 0, fmt_ui8,_print_ui8, _get_ui8, _set_ui8, (float *)&tg.network_mode,			NETWORK_MODE },
@@ -827,6 +836,7 @@ static stat_t _get_id(cmdObj_t *cmd)
  * _set_me() 	- enable motors with $Npm=0
  * _set_qv() 	- get a queue report verbosity
  * _get_qr() 	- get a queue report (as data)
+ * _get_qt() 	- get the ms of motion queued ahead of the running move
  * _run_qf() 	- execute a planner buffer flush
  * _get_er()	- invoke a bogus exception report for testing purposes (it's not real)
  * _get_rx()	- get bytes available in RX buffer
@@ -857,6 +867,13 @@ static stat_t _get_qr(cmdObj_t *cmd)
 	return (STAT_OK);
 }
 
+static stat_t _get_qt(cmdObj_t *cmd) 
+{
+	cmd->value = floor(max(mp_get_planner_queue_ms(), 0));
+	cmd->objtype = TYPE_INTEGER;
+	return (STAT_OK);
+}
+
 static stat_t _run_qf(cmdObj_t *cmd) 
 {
 	cm_request_queue_flush();
@@ -956,7 +973,7 @@ static stat_t _get_msg_helper(cmdObj_t *cmd, prog_char_ptr msg, uint8_t value)
 {
 	cmd->value = (float)value;
 	cmd->objtype = TYPE_INTEGER;
-	ritorno(cmd_copy_string_P(cmd, (PGM_P)pgm_read_word(&msg[value*2]))); // hack alert: direct computation of index
+	ritorno(cmd_copy_string_P(cmd, (PGM_P)pgm_read_word(&((PGM_P *)msg)[value]))); // msg is an array of PGM_P
 	return (STAT_OK);
 //	return((char *)pgm_read_word(&msg[(uint8_t)value]));
 }
@@ -1123,6 +1140,7 @@ static stat_t _run_home(cmdObj_t *cmd)
 
 /**** AXIS AND MOTOR FUNCTIONS ************************************************
  * _set_motor_steps_per_unit() - update this derived value
+ * _set_axis_squares() - update the derived jerk_max and junction_dev squares
  * _get_am() - get axis mode w/enumeration string
  * _set_am() - set axis mode w/exception handling for axis type
  * _set_sw() - run this any time you change a switch setting	
@@ -1131,6 +1149,8 @@ static stat_t _run_home(cmdObj_t *cmd)
  * _set_mi() - set microsteps & recompute steps_per_unit
  * _set_po() - set polarity and update stepper structs
  * _set_pm() - set motor power mode and take action
+ * _set_jm() - set axis jerk_max & recompute its square
+ * _set_jd() - set axis junction_dev & recompute its square
  *
  * _pr_ma_ui8() - print motor or axis uint8 value w/no units or unit conversion
  * _pr_ma_lin() - print linear value with units and in/mm unit conversion
@@ -1148,6 +1168,15 @@ static stat_t _set_motor_steps_per_unit(cmdObj_t *cmd)
 	return (STAT_OK);
 }
 
+// helper. The planner uses the squares (see _set_jerk_terms() and _get_junction_delta())
+static stat_t _set_axis_squares(cmdObj_t *cmd) 
+{
+	uint8_t a = _get_axis(cmd->index);
+	cfg.a[a].jerk_max_squared = square(cfg.a[a].jerk_max);
+	cfg.a[a].junction_dev_squared = square(cfg.a[a].junction_dev);
+	return (STAT_OK);
+}
+
 static stat_t _get_am(cmdObj_t *cmd)
 {
 	_get_ui8(cmd);
@@ -1217,6 +1246,20 @@ static stat_t _set_pm(cmdObj_t *cmd)		// motor power mode
 	return (STAT_OK);
 }
 
+static stat_t _set_jm(cmdObj_t *cmd)		// axis jerk max
+{
+	if (_get_axis(cmd->index) <= AXIS_Z) { _set_dbu(cmd);} else { _set_dbl(cmd);}
+	_set_axis_squares(cmd);
+	return (STAT_OK);
+}
+
+static stat_t _set_jd(cmdObj_t *cmd)		// axis junction deviation
+{
+	if (_get_axis(cmd->index) <= AXIS_Z) { _set_dbu(cmd);} else { _set_dbl(cmd);}
+	_set_axis_squares(cmd);
+	return (STAT_OK);
+}
+
 static void _pr_ma_ui8(cmdObj_t *cmd)		// print uint8_t value
 {
 	cmd_get(cmd);
@@ -1817,7 +1860,7 @@ static int8_t _get_motor(const index_t i)
 	}
 	return (ptr - motors);
 }
-/*
+
 static int8_t _get_axis(const index_t i)
 {
 	char *ptr;
@@ -1828,7 +1871,7 @@ static int8_t _get_axis(const index_t i)
 	if ((ptr = strchr(axes, tmp[0])) == NULL) { return (-1);}
 	return (ptr - axes);
 }
-*/
+
 static int8_t _get_pos_axis(const index_t i)
 {
 	char *ptr;
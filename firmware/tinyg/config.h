@@ -355,6 +355,8 @@ typedef struct cfgAxisParameters {
 	float travel_max;				// work envelope w/warned or rejected blocks
 	float jerk_max;					// max jerk (Jm) in mm/min^3
 	float junction_dev;				// aka cornering delta
+	float jerk_max_squared;			// derived - Jm^2, for planning
+	float junction_dev_squared;		// derived - junction_dev^2, for planning
 	float radius;					// radius in mm for rotary axis modes
 	float search_velocity;			// homing search velocity
 	float latch_velocity;			// homing latch velocity
@@ -402,7 +404,9 @@ typedef struct cfgParameters {
 	// hidden system settings
 	float min_segment_len;			// line drawing resolution in mm
 	float arc_segment_len;			// arc drawing resolution in mm
+	float coalesce_tolerance;		// collinear line coalescing tolerance in mm (0 = off)
 	float estd_segment_usec;		// approximate segment time in microseconds
+	float max_segment_usec;			// body segment time in microseconds
 //	uint8_t enable_acceleration;	// enable acceleration control
 
 	// gcode power-on default settings - defaults are not the same as the gm state
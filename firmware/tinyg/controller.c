@@ -103,6 +103,10 @@ void tg_init(uint8_t std_in, uint8_t std_out, uint8_t std_err)
  *
  * A routine that had no action (i.e. is OFF or idle) should return STAT_NOOP
  *
+ * One input line is read per pass. Every move, arcs included, is queued whole
+ * by the parser (see mp_arc()), so no task here feeds the planner piece by 
+ * piece and nothing needs to be batched to keep ahead of the runtime.
+ *
  * Useful reference on state machines:
  * http://johnsantic.com/comp/state.html, "Writing Efficient State Machines in C"
  */
@@ -111,6 +115,9 @@ void tg_controller()
 { 
 	while (true) { 
 		_controller_HSM();
+#ifdef __SIMULATION
+		if (sim_controller_callback() == STAT_COMPLETE) return;	// see sim/sim.c
+#endif
 	}
 }
 
@@ -135,17 +142,19 @@ static void _controller_HSM()
 	DISPATCH(_limit_switch_handler());		// 3. limit switch has been thrown
 	DISPATCH(_alarm_idler());				// 4. idle in alarm state
 	DISPATCH(_system_assertions());			// 5. system integrity assertions
+	DISPATCH(mp_stop_callback());			// enter a hold or end the cycle once the steppers stop
 	DISPATCH(cm_feedhold_sequencing_callback());
 	DISPATCH(mp_plan_hold_callback());		// plan a feedhold from line runtime
+	DISPATCH(mp_plan_override_callback());	// replan the running move for a feed rate override
+	DISPATCH(mp_start_callback());			// start an idle machine once the queue has filled
 
 //----- planner hierarchy for gcode and cycles -------------------------//
 	DISPATCH(rpt_status_report_callback());	// conditionally send status report
 	DISPATCH(rpt_queue_report_callback());	// conditionally send queue report
-	DISPATCH(ar_arc_callback());			// arc generation runs behind lines
 	DISPATCH(cm_homing_callback());			// G28.2 continuation
 
 //----- command readers and parsers ------------------------------------//
-	DISPATCH(_sync_to_planner());			// ensure there is at least one free buffer in planning queue
+	DISPATCH(_sync_to_planner());			// ensure a free buffer, stop reading when the queue is long enough
 	DISPATCH(_sync_to_tx_buffer());			// sync with TX buffer (pseudo-blocking)
 	DISPATCH(cfg_baud_rate_callback());		// perform baud rate update (must be after TX sync)
 	DISPATCH(_dispatch());					// read and execute next command
@@ -261,7 +270,7 @@ void tg_text_response(const uint8_t status, const char *buf)
 
 /**** Utilities ****
  * _sync_to_tx_buffer() - return eagain if TX queue is backed up
- * _sync_to_planner() - return eagain if planner is not ready for a new command
+ * _sync_to_planner() - return eagain if planner is out of buffers or has PLANNER_HORIZON_MAX_MS queued
  * tg_reset_source() - reset source to default input device (see note)
  * tg_set_active_source() - set current input source
  *
@@ -283,6 +292,9 @@ static stat_t _sync_to_planner()
 	if (mp_get_planner_buffers_available() < PLANNER_BUFFER_HEADROOM) { // allow up to N planner buffers for this line
 		return (STAT_EAGAIN);
 	}
+	if (mp_get_planner_lookahead_ms() > PLANNER_HORIZON_MAX_MS) {	// the planner already sees far enough ahead
+		return (STAT_EAGAIN);
+	}
 	return (STAT_OK);
 }
 
@@ -384,8 +396,6 @@ uint8_t _system_assertions()
 	if (mb.magic_end		!= MAGICNUM) { value = 12; }
 	if (mr.magic_start		!= MAGICNUM) { value = 13; }
 	if (mr.magic_end		!= MAGICNUM) { value = 14; }
-	if (ar.magic_start		!= MAGICNUM) { value = 15; }
-	if (ar.magic_end		!= MAGICNUM) { value = 16; }
 	if (st_get_st_magic()	!= MAGICNUM) { value = 17; }
 	if (st_get_sps_magic()	!= MAGICNUM) { value = 18; }
 	if (rtc.magic_end 		!= MAGICNUM) { value = 19; }
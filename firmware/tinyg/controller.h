@@ -65,6 +65,9 @@ void tg_request_reset(void);
 void tg_request_bootloader(void);
 void tg_reset(void);
 void tg_controller(void);
+#ifdef __SIMULATION
+stat_t sim_controller_callback(void);	// runs the virtual clock - see sim/sim.c
+#endif
 void tg_application_startup(void);
 void tg_reset_source(void);
 void tg_set_primary_source(uint8_t dev);
@@ -329,6 +329,7 @@ static stat_t _homing_axis_backoff_limit(int8_t axis)		// back off cleared limit
 static stat_t _homing_axis_search(int8_t axis)				// start the search
 {
 	cfg.a[axis].jerk_max = cfg.a[axis].jerk_homing;			// use the homing jerk for search onward
+	cfg.a[axis].jerk_max_squared = square(cfg.a[axis].jerk_max);
 	_homing_axis_move(axis, hm.search_travel, hm.search_velocity);
     return (_set_hm_func(_homing_axis_latch));
 }
@@ -349,6 +350,7 @@ static stat_t _homing_axis_set_zero(int8_t axis)			// set zero and finish up
 {
 	cm_set_machine_axis_position(axis, 0);
 	cfg.a[axis].jerk_max = hm.saved_jerk;					// restore the max jerk value
+	cfg.a[axis].jerk_max_squared = square(cfg.a[axis].jerk_max);
 	cm.homed[axis] = true;
 	return (_set_hm_func(_homing_axis_start));
 }
@@ -335,7 +335,16 @@ static stat_t _parse_gcode_block(char_t *buf)
 					case 9: SET_MODAL (MODAL_GROUP_M8, flood_coolant, false);
 					case 48: SET_MODAL (MODAL_GROUP_M9, override_enables, true);
 					case 49: SET_MODAL (MODAL_GROUP_M9, override_enables, false);
-					case 50: SET_MODAL (MODAL_GROUP_M9, feed_rate_override_enable, true); // conditionally true
+					case 50: {
+						switch (_point(value)) {
+							case 0: SET_MODAL (MODAL_GROUP_M9, feed_rate_override_enable, true); // conditionally true
+							case 1: SET_NON_MODAL (feed_rate_override_factor, true);	// factor is in P
+							case 2: SET_MODAL (MODAL_GROUP_M9, traverse_override_enable, true); // conditionally true
+							case 3: SET_NON_MODAL (traverse_override_factor, true);	// factor is in P
+							default: status = STAT_UNRECOGNIZED_COMMAND;
+						}
+						break;
+					}
 					case 51: SET_MODAL (MODAL_GROUP_M9, spindle_override_enable, true);	  // conditionally true
 					default: status = STAT_UNRECOGNIZED_COMMAND;
 				}
@@ -343,7 +352,7 @@ static stat_t _parse_gcode_block(char_t *buf)
 
 			case 'T': SET_NON_MODAL (tool, (uint8_t)trunc(value));
 			case 'F': SET_NON_MODAL (feed_rate, value);
-			case 'P': SET_NON_MODAL (parameter, value);				// used for dwell time, G10 coord select
+			case 'P': SET_NON_MODAL (parameter, value);				// used for dwell time, G10 coord select, G64 tolerance
 			case 'S': SET_NON_MODAL (spindle_speed, value); 
 			case 'X': SET_NON_MODAL (target[AXIS_X], value);
 			case 'Y': SET_NON_MODAL (target[AXIS_Y], value);
@@ -381,7 +390,7 @@ static stat_t _parse_gcode_block(char_t *buf)
  *		2. set feed rate mode (G93, G94 - inverse time or per minute)
  *		3. set feed rate (F)
  *		3a. set feed override rate (M50.1)
- *		3a. set traverse override rate (M50.2)
+ *		3a. set traverse override rate (M50.3)
  *		4. set spindle speed (S)
  *		4a. set spindle override rate (M51.1)
  *		5. select tool (T)
@@ -420,7 +429,7 @@ static stat_t _execute_gcode_block()
 	EXEC_FUNC(cm_set_spindle_speed, spindle_speed);
 	EXEC_FUNC(cm_spindle_override_factor, spindle_override_factor);
 	EXEC_FUNC(cm_select_tool, tool);
-	EXEC_FUNC(cm_change_tool, tool);
+	if ((uint8_t)gf.change_tool != false) { EXEC_FUNC(cm_change_tool, tool);}	// M6 Tn - a T by itself only selects
 	EXEC_FUNC(cm_spindle_control, spindle_mode); 	// spindle on or off
 	EXEC_FUNC(cm_mist_coolant_control, mist_coolant); 
 	EXEC_FUNC(cm_flood_coolant_control, flood_coolant);	// also disables mist coolant if OFF 
@@ -437,7 +446,9 @@ static stat_t _execute_gcode_block()
 	//--> cutter radius compensation goes here
 	//--> cutter length compensation goes here
 	EXEC_FUNC(cm_set_coord_system, coord_system);
-	EXEC_FUNC(cm_set_path_control, path_control);
+	if (gf.path_control == true) {					// G64 P sets the blending tolerance
+		status = cm_set_path_control(gn.path_control, (((uint8_t)gf.parameter != false) ? gn.parameter : 0));
+	}
 	EXEC_FUNC(cm_set_distance_mode, distance_mode);
 	//--> set retract mode goes here
 
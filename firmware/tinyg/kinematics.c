@@ -44,6 +44,10 @@
  *	Performs axis mapping & conversion of length units to steps (see note)
  *	Also deals with inhibited axes
  *
+ *	Only the axes set in the axes bitmask are converted. Motors mapped to other
+ *	axes get zero steps. Returns the bitmask of motors that were given steps,
+ *	for st_prep_line().
+ *
  *	Note: The reason steps are returned as floats (as opposed to, say,
  *		  uint32_t) is to accommodate fractional DDA steps. The DDA deals 
  *		  with fractional step values as fixed-point binary in order to get
@@ -52,9 +56,10 @@
  *		  loading. See stepper.c for details.
  */
 
-void ik_kinematics(float travel[], float steps[], float microseconds)
+uint8_t ik_kinematics(const uint8_t axes, float travel[], float steps[], float microseconds)
 {
 	uint8_t i;
+	uint8_t motors = 0;
 	float joint[AXES];
 
 //	_inverse_kinematics(travel, joint, microseconds);// you can insert inverse kinematics transformations here
@@ -63,17 +68,23 @@ void ik_kinematics(float travel[], float steps[], float microseconds)
 	// Map motors to axes and convert length units to steps
 	// Most of the conversion math has already been done in steps_per_unit
 	// which takes axis travel, step angle and microsteps into account.
+	steps[MOTOR_1] = 0;
+	steps[MOTOR_2] = 0;
+	steps[MOTOR_3] = 0;
+	steps[MOTOR_4] = 0;
 	for (i=0; i<AXES; i++) {
-		if (cfg.a[i].axis_mode == AXIS_INHIBITED) { joint[i] = 0;}
-		if (cfg.m[MOTOR_1].motor_map == i) { steps[MOTOR_1] = joint[i] * cfg.m[MOTOR_1].steps_per_unit;}
-		if (cfg.m[MOTOR_2].motor_map == i) { steps[MOTOR_2] = joint[i] * cfg.m[MOTOR_2].steps_per_unit;}
-		if (cfg.m[MOTOR_3].motor_map == i) { steps[MOTOR_3] = joint[i] * cfg.m[MOTOR_3].steps_per_unit;}
-		if (cfg.m[MOTOR_4].motor_map == i) { steps[MOTOR_4] = joint[i] * cfg.m[MOTOR_4].steps_per_unit;}
+		if ((axes & (1<<i)) == 0) { continue;}
+		if (cfg.a[i].axis_mode == AXIS_INHIBITED) { continue;}
+		if (cfg.m[MOTOR_1].motor_map == i) { steps[MOTOR_1] = joint[i] * cfg.m[MOTOR_1].steps_per_unit; motors |= (1<<MOTOR_1);}
+		if (cfg.m[MOTOR_2].motor_map == i) { steps[MOTOR_2] = joint[i] * cfg.m[MOTOR_2].steps_per_unit; motors |= (1<<MOTOR_2);}
+		if (cfg.m[MOTOR_3].motor_map == i) { steps[MOTOR_3] = joint[i] * cfg.m[MOTOR_3].steps_per_unit; motors |= (1<<MOTOR_3);}
+		if (cfg.m[MOTOR_4].motor_map == i) { steps[MOTOR_4] = joint[i] * cfg.m[MOTOR_4].steps_per_unit; motors |= (1<<MOTOR_4);}
 	// the above is a loop unrolled version of this:
 	//	for (uint8_t j=0; j<MOTORS; j++) {
-	//		if (cfg.m[j].motor_map == i) { steps[j] = joint[i] * cfg.m[j].steps_per_unit;}
+	//		if (cfg.m[j].motor_map == i) { steps[j] = joint[i] * cfg.m[j].steps_per_unit; motors |= (1<<j);}
 	//	}
 	}
+	return (motors);
 }
 
 /*
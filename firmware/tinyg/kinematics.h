@@ -38,7 +38,7 @@
  * Global Scope Functions
  */
 
-void ik_kinematics(float travel[], float steps[], float microseconds);
+uint8_t ik_kinematics(const uint8_t axes, float travel[], float steps[], float microseconds);
 
 //#ifdef __UNIT_TESTS
 //void ik_unit_tests(void);
@@ -45,18 +45,16 @@
  */
 static stat_t _compute_center_arc(void);
 static stat_t _get_arc_radius(void);
-static float _get_arc_time (const float linear_travel, const float angular_travel, const float radius);
+static float _get_arc_time (const float linear_travel, const float angular_travel, const float radius, float *min_time);
 static float _get_theta(const float x, const float y);
 
 /*****************************************************************************
- * mp_arc() - setup an arc move for runtime
+ * ar_arc() - queue an arc move
  *
- *	Generates an arc by queueing line segments to the move buffer.
- *	The arc is approximated by generating a large number of tiny, linear
- *	segments. The length of the segments is configured in motion_control.h
- *	as MM_PER_ARC_SEGMENT.
- *
- *  Parts of this routine were originally sourced from the grbl project.
+ *	The arc or helix is planned and run as a single block (see mp_arc()). It 
+ *	used to be drawn as a chain of short lines queued from the main loop, which
+ *	took a planner buffer and a pass of the backward planner per segment. The 
+ *	runtime now puts each segment on the arc, so arcs no longer fill the queue.
  */
 stat_t ar_arc( const float target[], 
 				const float i, const float j, const float k, 
@@ -71,96 +69,20 @@ stat_t ar_arc( const float target[],
 				const float work_offset[],	// offset from work coordinate system
 				const float min_time)		// minimum time for arc for replanning purposes
 {
-	if (ar.run_state != MOVE_STATE_OFF) {
-		return (STAT_INTERNAL_ERROR);			// (not supposed to fail)
-	}
-	ar.linenum = cm_get_model_linenum();	// get gcode model line number as debugging convenience
+	float endpoint[AXES];
 
-	// "move_length" is the total mm of travel of the helix (or just arc)
-	ar.length = hypot(angular_travel * radius, fabs(linear_travel));	
-	if (ar.length < cfg.arc_segment_len) {	// too short to draw
+	// "length" is the total mm of travel of the helix (or just arc)
+	float length = hypot(angular_travel * radius, fabs(linear_travel));	
+	if (length < cfg.arc_segment_len) {		// too short to draw
 		return (STAT_MINIMUM_LENGTH_MOVE_ERROR);
 	}
-
-	// load the move struct for an arc
-	cm_get_model_canonical_position_vector(ar.position);// set initial arc position
-
-//	copy_axis_vector(ar.endpoint, target);
-	ar.endpoint[axis_1] = target[0];					// save the arc endpoint
-	ar.endpoint[axis_2] = target[1];
-	ar.endpoint[axis_linear] = target[2];
-
-	copy_axis_vector(ar.work_offset, work_offset);		// propagate the work offset
-	ar.time = minutes;
-	ar.min_time = min_time;
-	ar.theta = theta;
-	ar.radius = radius;
-	ar.axis_1 = axis_1;
-	ar.axis_2 = axis_2;
-	ar.axis_linear = axis_linear;
-	ar.angular_travel = angular_travel;
-	ar.linear_travel = linear_travel;
-	
-	// Find the minimum number of segments that meets these constraints...
-	float segments_required_for_chordal_accuracy = ar.length / sqrt(4*cfg.chordal_tolerance * (2 * radius - cfg.chordal_tolerance));
-	float segments_required_for_minimum_distance = ar.length / cfg.arc_segment_len;
-	float segments_required_for_minimum_time = ar.time * MICROSECONDS_PER_MINUTE / MIN_ARC_SEGMENT_USEC;
-	ar.segments = floor(min3(segments_required_for_chordal_accuracy,
-							 segments_required_for_minimum_distance,
-							 segments_required_for_minimum_time));
-	ar.segments = max(ar.segments,1);		//...but is at least 1 segment
-
-	ar.segment_count = (uint32_t)ar.segments;
-	ar.segment_theta = ar.angular_travel / ar.segments;
-	ar.segment_linear_travel = ar.linear_travel / ar.segments;
-	ar.segment_time = ar.time / ar.segments;
-	ar.center_1 = ar.position[ar.axis_1] - sin(ar.theta) * ar.radius;
-	ar.center_2 = ar.position[ar.axis_2] - cos(ar.theta) * ar.radius;
-	ar.target[ar.axis_linear] = ar.position[ar.axis_linear];
-	ar.run_state = MOVE_STATE_RUN;
-	return (STAT_OK);
-}
-
-/*
- * ar_arc_callback() - generate an arc
- *
- *	ar_arc_callback() is structured as a continuation called by mp_move_dispatcher.
- *	Each time it's called it queues as many arc segments (lines) as it can 
- *	before it blocks, then returns.
- *
- *  Parts of this routine were originally sourced from the grbl project.
- */
-
-stat_t ar_arc_callback() 
-{
-	if (ar.run_state == MOVE_STATE_OFF) { return (STAT_NOOP);}
-	if (mp_get_planner_buffers_available() == 0) { return (STAT_EAGAIN);}
-	if (ar.run_state == MOVE_STATE_RUN) {
-		if (--ar.segment_count > 0) {
-			ar.theta += ar.segment_theta;
-			ar.target[ar.axis_1] = ar.center_1 + sin(ar.theta) * ar.radius;
-			ar.target[ar.axis_2] = ar.center_2 + cos(ar.theta) * ar.radius;
-			ar.target[ar.axis_linear] += ar.segment_linear_travel;
-			(void)MP_LINE(ar.target, ar.segment_time, ar.work_offset, 0);
-			copy_axis_vector(ar.position, ar.target);	// update runtime position	
-			return (STAT_EAGAIN);
-		} else {
-			(void)MP_LINE(ar.endpoint, ar.segment_time, ar.work_offset,0);// do last segment to the exact endpoint
-		}
-	}
-	ar.run_state = MOVE_STATE_OFF;
-	return (STAT_OK);
-}
-
-/*
- * ar_abort_arc() - stop an arc.
- *
- *	OK to call if no arc is running
- */
-
-void ar_abort_arc() 
-{
-	ar.run_state = MOVE_STATE_OFF;
+	endpoint[axis_1] = target[0];
+	endpoint[axis_2] = target[1];
+	endpoint[axis_linear] = target[2];
+	endpoint[AXIS_A] = target[3];			// rotary axes move along the arc (see mp_arc())
+	endpoint[AXIS_B] = target[4];
+	endpoint[AXIS_C] = target[5];
+	return (mp_arc(endpoint, theta, radius, angular_travel, axis_1, axis_2, minutes, work_offset, min_time));
 }
 
 /*****************************************************************************
@@ -208,12 +130,6 @@ stat_t cm_arc_feed(float target[], float flags[],	// arc endpoints
 		}
 	}
 
-	// Introduce a short dwell if the machine is idle to enable the planning
-	// queue to begin to fill (avoids first block having to plan down to zero)
-//	if (st_isbusy() == false) {
-//		cm_dwell(PLANNER_STARTUP_DELAY_SECONDS);
-//	}
-
 	// execute the move
 	status = _compute_center_arc();
 	cm_set_gcode_model_endpoint_position(status);
@@ -272,7 +188,8 @@ static stat_t _compute_center_arc()
 	// and compute the time it should take to perform the move
 	float radius_tmp = hypot(gm.arc_offset[gm.plane_axis_0], gm.arc_offset[gm.plane_axis_1]);
 	float linear_travel = gm.target[gm.plane_axis_2] - gm.position[gm.plane_axis_2];
-	float move_time = _get_arc_time(linear_travel, angular_travel, radius_tmp);
+	float min_time;
+	float move_time = _get_arc_time(linear_travel, angular_travel, radius_tmp, &min_time);
 
 	// Trace the arc
 	set_vector(gm.target[gm.plane_axis_0], gm.target[gm.plane_axis_1], gm.target[gm.plane_axis_2],
@@ -284,7 +201,7 @@ static stat_t _compute_center_arc()
 				  gm.arc_offset[gm.plane_axis_2],
 				  theta_start, radius_tmp, angular_travel, linear_travel, 
 				  gm.plane_axis_0, gm.plane_axis_1, gm.plane_axis_2, 
-				  move_time, gm.work_offset, gm.min_time));
+				  move_time, gm.work_offset, min_time));
 }
 
 /* 
@@ -410,11 +327,15 @@ static stat_t _get_arc_radius()
  *
  *	Room for improvement: At least take the hypotenuse of the planar movement 
  *	and the linear travel into account, but how many people actually use helixes?
+ *
+ *	The time taken by the slowest dimension alone is returned as min_time. 
+ *	It bounds how far a feed rate override can speed the arc up.
  */
 
 static float _get_arc_time (const float linear_travel, 	// in mm
 							 const float angular_travel, 	// in radians
-							 const float radius)			// in mm
+							 const float radius,			// in mm
+							 float *min_time)				// time of the rate-limiting axis
 {
 	float tmp;
 	float move_time=0;	// picks through the times and retains the slowest
@@ -434,7 +355,14 @@ static float _get_arc_time (const float linear_travel, 	// in mm
 	if ((tmp = fabs(linear_travel/cfg.a[gm.plane_axis_2].feedrate_max)) > move_time) {
 		move_time = tmp;
 	}
-	return (move_time);
+	*min_time = max3(planar_travel/cfg.a[gm.plane_axis_0].feedrate_max,
+					 planar_travel/cfg.a[gm.plane_axis_1].feedrate_max,
+					 fabs(linear_travel/cfg.a[gm.plane_axis_2].feedrate_max));
+	for (uint8_t i=AXIS_A; i<=AXIS_C; i++) {		// rotary travel along the arc
+		tmp = fabs(gm.target[i] - gm.position[i]) / cfg.a[i].feedrate_max;
+		*min_time = max(*min_time, tmp);
+	}
+	return (max(move_time, *min_time));
 }
 
 /* 
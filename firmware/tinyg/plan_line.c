@@ -47,17 +47,50 @@ static void _calculate_trapezoid(mpBuf_t *bf);
 static float _get_target_length(const float Vi, const float Vt, const mpBuf_t *bf);
 static float _get_target_velocity(const float Vi, const float L, const mpBuf_t *bf);
 //static float _get_intersection_distance(const float Vi_squared, const float Vt_squared, const float L, const mpBuf_t *bf);
-static float _get_junction_vmax(const float a_unit[], const float b_unit[]);
+static float _get_junction_vmax(const float a_unit[], const float b_unit[], float *a_delta, float *b_delta);
+static float _get_junction_delta(const float unit[]);
 static void _reset_replannable_list(void);
+static stat_t _queue_work_offset(const float work_offset[]);
+static stat_t _queue_aline(const float target[], const float minutes, const float min_time);
+static float _get_arc_vmax(const float radius);
+static stat_t _queue_block(mpBuf_t *bf, const float target[], const float minutes, const float min_time,
+						   const float entry_unit[], const float exit_unit[], const uint8_t straight,
+						   const uint8_t move_type);
+static mpBuf_t *_get_open_line(void);
+static uint8_t _coalesce_line(const float target[], const float minutes, const float min_time);
+static stat_t _blend_corner(const float target[], const float length, const float minutes, const float min_time,
+							float *fraction);
+static void _set_jerk_terms(mpBuf_t *bf, const float unit[]);
+static float _get_cruise_vmax(const mpBuf_t *bf);
+static mpBuf_t *_get_prev_move(mpBuf_t *bf);
+static float _get_horizon_time(const float minutes);
 
 // execute routines (NB: These are all called from the LO interrupt)
 static stat_t _exec_aline(mpBuf_t *bf);
+static stat_t _exec_work_offset(mpBuf_t *bf);
 static stat_t _exec_aline_head(void);
 static stat_t _exec_aline_body(void);
 static stat_t _exec_aline_tail(void);
-static stat_t _exec_aline_segment(uint8_t correction_flag);
-static void _init_forward_diffs(float t0, float t2);
+static stat_t _exec_aline_segment(uint8_t last_half);
+static void _load_aline(mpMoveRuntimeSingleton_t *m, const mpBuf_t *bf);
+static stat_t _init_aline_head(mpMoveRuntimeSingleton_t *m);
+static stat_t _init_aline_body(mpMoveRuntimeSingleton_t *m);
+static stat_t _init_aline_tail(mpMoveRuntimeSingleton_t *m);
+static mpBuf_t *_get_preload_buffer(void);
+static uint8_t _swap_in_preload(const mpBuf_t *bf);
+static void _init_forward_diffs(mpMoveRuntimeSingleton_t *m, float vs, uint8_t second_half);
+static void _init_section_end(mpMoveRuntimeSingleton_t *m, const float length, const uint8_t last);
+static float _get_runtime_point(const mpMoveRuntimeSingleton_t *m, const float length, float point[]);
+static float _get_runtime_length(const mpMoveRuntimeSingleton_t *m);
+static void _load_arc(mpMoveRuntimeSingleton_t *m, const mpBuf_t *bf);
+static void _get_arc_center(const mpBuf_t *bf, float *center_1, float *center_2);
+static void _set_arc_offsets(mpMoveRuntimeSingleton_t *m);
+static void _set_arc_target(void);
+static float _get_ramp_segment_usec(const float move_time, const float velocity_change);
+static float _get_segments(const float section_usec, const float segment_usec);
 static float _compute_next_segment_velocity(void);
+static void _plan_hold_tail(mpBuf_t *bf, const float entry_velocity, const float exit_velocity);
+static stat_t _plan_hold_queue(void);
 
 /* 
  * mp_isbusy() - return TRUE if motion control busy (i.e. robot is moving)
@@ -68,7 +101,7 @@ static float _compute_next_segment_velocity(void);
 
 uint8_t mp_isbusy()
 {
-	if ((st_isbusy() == true) || (mr.move_state > MOVE_STATE_NEW)) {
+	if ((st_isbusy() == true) || (st_prep_isbusy() == true) || (mr.move_state > MOVE_STATE_NEW)) {
 		return (true);
 	}
 	return (false);
@@ -105,6 +138,45 @@ void mp_set_runtime_work_offset(float offset[]) {
 	copy_axis_vector(mr.work_offset, offset);
 }
 
+/*
+ * _queue_work_offset() - queue a change of work offset to the runtime
+ * _exec_work_offset()	- runtime half: set the offset used for reporting
+ *
+ *	The work offset is only used to report work positions and it rarely changes,
+ *	so it is not carried in every line buffer. mp_aline() queues one of these 
+ *	just ahead of the line whenever the offset differs from the last one queued.
+ *	The offset rides in the target[] of a zero length block that is planned 
+ *	straight through like an inline command (see mp_queue_inline_command()), so
+ *	it takes effect at the start of the line without stopping motion. G54-G59 
+ *	and G92 queue their own command as before; a G10 L2 between moves adds no stop.
+ */
+static stat_t _queue_work_offset(const float work_offset[])
+{
+	mpBuf_t *bf;
+
+	if ((bf = mp_get_write_buffer()) == NULL) { return (STAT_BUFFER_FULL_FATAL);} // never supposed to fail
+	bf->bf_func = _exec_work_offset;
+	copy_axis_vector(bf->target, work_offset);
+	copy_axis_vector(mm.work_offset, work_offset);
+	bf->replannable = true;
+	bf->entry_vmax = PASS_THROUGH_VMAX;
+	bf->cruise_vmax = PASS_THROUGH_VMAX;
+	bf->exit_vmax = PASS_THROUGH_VMAX;
+	mp_queue_write_buffer(MOVE_TYPE_INLINE_COMMAND);
+	return (STAT_OK);
+}
+
+static stat_t _exec_work_offset(mpBuf_t *bf)
+{
+	copy_axis_vector(mr.work_offset, bf->target);
+	if (((st_isbusy() == true) || (st_prep_isbusy() == true)) &&	// in motion: the line runs next
+		((bf->nx->buffer_state == MP_BUFFER_QUEUED) || (bf->nx->buffer_state == MP_BUFFER_PENDING))) {
+		bf->nx->replannable = false;		// (see _exec_aline())
+	}
+	mp_free_run_buffer();
+	return (STAT_OK);						// _exec_move() runs the line
+}
+
 void mp_zero_segment_velocity() 
 {
 	mr.segment_velocity = 0;
@@ -129,87 +201,543 @@ void mp_zero_segment_velocity()
  *	Note: Returning a status that is not STAT_OK means the endpoint is NOT
  *	advanced. So lines that are too short to move will accumulate and get 
  *	executed once the accumlated error exceeds the minimums 
+ *
+ *	Note: Buffers do not carry a unit vector or a work offset. The runtime 
+ *	derives the unit vector from its actual position and the target, which 
+ *	also steers out any position error left at the end of the previous move.
+ *	The work offset is queued only when it changes (see _queue_work_offset()).
  */
 
 stat_t mp_aline(const float target[], const float minutes, const float work_offset[], const float min_time)
 {
-	mpBuf_t *bf; 						// current move pointer
-	float exact_stop = 0;
-	float junction_velocity;
-
 	// trap error conditions
 	float length = get_axis_vector_length(target, mm.position);
 	if (length < MIN_LENGTH_MOVE) { return (STAT_MINIMUM_LENGTH_MOVE_ERROR);}
 //	if (minutes < MIN_TIME_MOVE) { return (STAT_MINIMUM_TIME_MOVE_ERROR);}	// remove this line
 
+	// queue a work offset change ahead of the line
+	if (vector_equal(work_offset, mm.work_offset) == false) {
+		if (_queue_work_offset(work_offset) != STAT_OK) { return (STAT_BUFFER_FULL_FATAL);}
+	}
+
+	// slow the line down if the queue is running dry
+	float horizon_minutes = _get_horizon_time(minutes);
+
+	// extend the last queued line if this one continues it (stretched the same)
+	if (_coalesce_line(target, horizon_minutes, min_time) == true) { return (STAT_OK);}
+
+	// round the corner into this line if G64 P allows it. The line then starts
+	// where the blend ends, so only the part of it that is left is queued
+	float fraction;
+	stat_t status = _blend_corner(target, length, horizon_minutes, min_time, &fraction);
+	if (status != STAT_OK) { return (status);}
+	return (_queue_aline(target, horizon_minutes * fraction, min_time * fraction));
+}
+
+/*
+ * _get_horizon_time() - stretch a line's time if the queue is running dry
+ *
+ *	When the sender can't keep up the queue drains, every line ends up planned 
+ *	to zero and the machine stutters through the program. If a machining cycle
+ *	is running and the queue holds less than PLANNER_HORIZON_LOW_MS of motion 
+ *	with more than half the buffers free (so it is input that is short, not 
+ *	buffers), the new line is stretched by half the shortfall. That caps its 
+ *	cruise velocity: the machine slows down and the queue refills before it 
+ *	runs out. Lines that arrive in time are left alone.
+ */
+static float _get_horizon_time(const float minutes)
+{
+	if ((cm.cycle_state != CYCLE_MACHINING) || (mr.move_state == MOVE_STATE_OFF) ||
+		(mp_get_planner_buffers_available() <= (PLANNER_BUFFER_POOL_SIZE / 2))) {
+		return (minutes);
+	}
+	float shortfall = (PLANNER_HORIZON_LOW_MS - mp_get_planner_queue_ms()) / 60000;	// in minutes
+	if (minutes >= shortfall) { return (minutes);}
+	return (minutes + (shortfall - minutes) / 2);
+}
+
+/*
+ * _queue_aline() - queue a line from the planning position and replan the block list
+ */
+static stat_t _queue_aline(const float target[], const float minutes, const float min_time)
+{
+	mpBuf_t *bf; 						// current move pointer
+
 	// get a cleared buffer and setup move variables
 	if ((bf = mp_get_write_buffer()) == NULL) { return (STAT_BUFFER_FULL_FATAL);} // never supposed to fail
+	bf->length = get_axis_vector_length(target, mm.position);
+
+	// Set unit vector and jerk terms. The unit vector is not kept in the buffer:
+	// the runtime derives it again from the target (see _exec_aline())
+	float unit[AXES];
+	set_unit_vector(unit, target, mm.position, bf->length);
+	_set_jerk_terms(bf, unit);
+	return (_queue_block(bf, target, minutes, min_time, unit, unit, true, MOVE_TYPE_ALINE));
+}
+
+/*
+ * mp_arc() - plan an arc or helix as a single block
+ *
+ *	An arc used to be queued as a line per arc segment, each taking a buffer and
+ *	a replan, so one G2 could fill the queue and the look-ahead ended at the arc.
+ *	It is now one MOVE_TYPE_ARC block, planned as a path of the helix length, and 
+ *	it is cut into segments only by the runtime (see _set_arc_target()).
+ *
+ *	The block keeps what the runtime needs to place a point anywhere along it: the
+ *	plane axes, the radius, the angle at the target (theta) and the angular 
+ *	travel per mm of path; the center is found from those and the target. The 
+ *	angular travel is that rate times the length, and the helix pitch is the rest
+ *	of the target's travel over it. The angle is kept at the target rather than 
+ *	the start so a block that a feedhold or an override starts part way along 
+ *	(re-using bp+0) still describes itself.
+ *
+ *	A line only turns at its ends. An arc turns all along, so it is also held to 
+ *	the velocity limit of its curvature (see _get_arc_vmax()). The limit is on the
+ *	travel in the plane - the axes off it (a helix, or A, B and C) don't turn - and
+ *	goes into the block time and min_time, so a feed rate override can't push past it. The
+ *	jerk is that of the slower plane axis, as the direction runs all round the 
+ *	plane. The junction before the arc is taken with the tangent it starts in and
+ *	the junction after it with the tangent it ends in.
+ *
+ *	The block ends where the arc does. A target off the arc (an arc specified with
+ *	I and J off the radius of the end point) is reached by a line from there, as 
+ *	the last segment line used to reach it. 
+ */
+stat_t mp_arc(const float target[], const float theta, const float radius, const float angular_travel,
+			  const uint8_t axis_1, const uint8_t axis_2, const float minutes, const float work_offset[], const float min_time)
+{
+	mpBuf_t *bf;
+	float endpoint[AXES];
+	float entry_unit[AXES];
+	float exit_unit[AXES];
+	float jerk_unit[AXES];
+	uint8_t i;
+
+	// the length of the helix: the arc in the plane and the travel on the other axes
+	float length = square(angular_travel * radius);
+	for (i=0; i<AXES; i++) {
+		if ((i == axis_1) || (i == axis_2)) { continue;}
+		length += square(target[i] - mm.position[i]);
+	}
+	length = sqrt(length);
+	if (length < MIN_LENGTH_MOVE) { return (STAT_MINIMUM_LENGTH_MOVE_ERROR);}
+
+	// queue a work offset change ahead of the arc
+	if (vector_equal(work_offset, mm.work_offset) == false) {
+		if (_queue_work_offset(work_offset) != STAT_OK) { return (STAT_BUFFER_FULL_FATAL);}
+	}
+	float arc_minutes = fabs(angular_travel * radius) / _get_arc_vmax(radius);	// a limit on the plane travel
+	float horizon_minutes = _get_horizon_time(max(minutes, arc_minutes));
+
+	if ((bf = mp_get_write_buffer()) == NULL) { return (STAT_BUFFER_FULL_FATAL);} // never supposed to fail
+	bf->length = length;
+	bf->axis_1 = axis_1;
+	bf->axis_2 = axis_2;
+	bf->radius = radius;
+	bf->angular_rate = angular_travel / length;
+	bf->theta = theta + angular_travel;
+	float center_1 = mm.position[axis_1] - (sin(theta) * radius);
+	float center_2 = mm.position[axis_2] - (cos(theta) * radius);
+	copy_axis_vector(endpoint, target);
+	endpoint[axis_1] = center_1 + (sin(bf->theta) * radius);
+	endpoint[axis_2] = center_2 + (cos(bf->theta) * radius);
+
+	// the tangents at the start and the end (the change in the arc point per mm of path)
+	float plane_rate = radius * bf->angular_rate;
+	for (i=0; i<AXES; i++) {
+		entry_unit[i] = (target[i] - mm.position[i]) / length;
+	}
+	copy_axis_vector(exit_unit, entry_unit);
+	entry_unit[axis_1] = plane_rate * cos(theta);
+	entry_unit[axis_2] = -plane_rate * sin(theta);
+	exit_unit[axis_1] = plane_rate * cos(bf->theta);
+	exit_unit[axis_2] = -plane_rate * sin(bf->theta);
+
+	// jerk terms for the plane travel all on the slower plane axis
+	copy_axis_vector(jerk_unit, entry_unit);
+	jerk_unit[axis_1] = 0;
+	jerk_unit[axis_2] = 0;
+	if (cfg.a[axis_1].jerk_max_squared < cfg.a[axis_2].jerk_max_squared) {
+		jerk_unit[axis_1] = fabs(plane_rate);
+	} else {
+		jerk_unit[axis_2] = fabs(plane_rate);
+	}
+	_set_jerk_terms(bf, jerk_unit);
+	bf->axes |= (1<<axis_1) | (1<<axis_2);
+	MP_STAT(mps.arcs++);
+	stat_t status = _queue_block(bf, endpoint, horizon_minutes, max(min_time, arc_minutes), entry_unit, exit_unit, false, MOVE_TYPE_ARC);
+	if (status != STAT_OK) { return (status);}
+
+	float gap = get_axis_vector_length(target, endpoint);
+	if (gap < MIN_LENGTH_MOVE) { return (STAT_OK);}	// the next move takes up the rest
+	return (mp_aline(target, (minutes * gap / length), work_offset, (min_time * gap / length)));
+}
+
+/*
+ * _get_arc_vmax() - velocity limit of an arc of a radius
+ *
+ *	The lesser of the velocity that holds the centripetal acceleration to the 
+ *	junction acceleration, sqrt($ja * R) as for corner blends, and the velocity
+ *	at which the longest segments ($mx) are chords that stay within the chordal 
+ *	tolerance ($ct) of the arc.
+ */
+static float _get_arc_vmax(const float radius)
+{
+	float vmax = sqrt(radius * cfg.junction_acceleration);
+	if ((cfg.chordal_tolerance > EPSILON) && (cfg.chordal_tolerance < radius)) {
+		float chord = sqrt(4 * cfg.chordal_tolerance * (2 * radius - cfg.chordal_tolerance));
+		vmax = min(vmax, (chord * MICROSECONDS_PER_MINUTE / cfg.max_segment_usec));
+	}
+	return (max(vmax, EPSILON));
+}
+
+/*
+ * _queue_block() - finish a line or arc block, replan the block list and queue it
+ *
+ *	The block's length and jerk terms are set. entry_unit is the direction it 
+ *	starts in, for the junction with the block before it, and exit_unit the one
+ *	it ends in, for the junction with the next block. A line passes its unit 
+ *	vector as both and sets straight, so the junction delta found for its entry
+ *	carries over to its exit; an arc clears it and its exit delta is computed
+ *	at the next junction.
+ */
+static stat_t _queue_block(mpBuf_t *bf, const float target[], const float minutes, const float min_time,
+						   const float entry_unit[], const float exit_unit[], const uint8_t straight,
+						   const uint8_t move_type)
+{
+	mpBuf_t *pv = _get_prev_move(bf);
+	float exact_stop = 0;
+	float junction_velocity;
 
 	bf->bf_func = _exec_aline;					// register the callback to the exec function
 	bf->linenum = cm_get_model_linenum();		// block being planned
 	bf->motion_mode = cm_get_model_motion_mode();
 	bf->time = minutes;
 	bf->min_time = min_time;
-	bf->length = length;
 	copy_axis_vector(bf->target, target); 		// set target for runtime
-	copy_axis_vector(bf->work_offset, work_offset);// propagate offset
 
-	// Set unit vector and jerk terms - this is all done together for efficiency 
-	float jerk_squared = 0;
-	float diff = target[AXIS_X] - mm.position[AXIS_X];
-	if (fp_NOT_ZERO(diff)) { 
-		bf->unit[AXIS_X] = diff / length;
-		jerk_squared += square(bf->unit[AXIS_X] * cfg.a[AXIS_X].jerk_max);
+	// finish up the current block variables
+	if (cm_get_model_path_control() != PATH_EXACT_STOP) { // exact stop cases already zeroed
+		bf->replannable = true;
+		exact_stop = 12345678;					// an arbitrarily large floating point number
 	}
-	if (fp_NOT_ZERO(diff = target[AXIS_Y] - mm.position[AXIS_Y])) { 
-		bf->unit[AXIS_Y] = diff / length;
-		jerk_squared += square(bf->unit[AXIS_Y] * cfg.a[AXIS_Y].jerk_max);
+	bf->cruise_vmax = _get_cruise_vmax(bf);	// target velocity requested
+	if (mp_is_aline(pv) == false) {				// the previous block plans to zero
+		clear_vector(mm.unit);
+		mm.junction_delta = 0;
 	}
-	if (fp_NOT_ZERO(diff = target[AXIS_Z] - mm.position[AXIS_Z])) { 
-		bf->unit[AXIS_Z] = diff / length;
-		jerk_squared += square(bf->unit[AXIS_Z] * cfg.a[AXIS_Z].jerk_max);
+	float junction_delta = JUNCTION_DELTA_UNKNOWN;
+	junction_velocity = _get_junction_vmax(mm.unit, entry_unit, &mm.junction_delta, &junction_delta);
+	bf->junction_vmax = min(junction_velocity, exact_stop);
+	copy_axis_vector(mm.coalesce_pv_unit, mm.unit);	// start a new coalescing run
+	mm.coalesce_pv_delta = mm.junction_delta;
+	copy_axis_vector(mm.coalesce_start, mm.position);
+	copy_axis_vector(mm.coalesce_unit, entry_unit);
+	mm.coalesce_along = bf->length;
+	copy_axis_vector(mm.unit, exit_unit);
+	mm.junction_delta = (straight == true) ? junction_delta : JUNCTION_DELTA_UNKNOWN;
+	bf->entry_vmax = min(bf->cruise_vmax, bf->junction_vmax);
+	bf->delta_vmax = _get_target_velocity(0, bf->length, bf);
+	bf->exit_vmax = min3(bf->cruise_vmax, (bf->entry_vmax + bf->delta_vmax), exact_stop);
+	bf->braking_velocity = bf->delta_vmax;
+
+	uint8_t mr_flag = false;
+	_plan_block_list(bf, &mr_flag);				// replan block list and commit current block
+	copy_axis_vector(mm.position, bf->target);	// update planning position
+	mp_queue_write_buffer(move_type);
+	MP_STAT(mps.blocks++);
+	return (STAT_OK);
+}
+
+/*
+ * _set_jerk_terms() - set jerk, the compute-once jerk terms and the axes for a unit vector
+ *
+ *	The axes that move are found in the same pass. The runtime and the steppers
+ *	only do the per-segment math for them (see _exec_aline_segment()).
+ *
+ *	The cube root and reciprocal are taken from the jerk cache if a recent move
+ *	had the same jerk. Jerk depends on the direction, so raster and braid paths 
+ *	that alternate between a few directions would miss a single slot every block.
+ *	A miss replaces the slots in turn.
+ */
+static void _set_jerk_terms(mpBuf_t *bf, const float unit[])
+{
+	float jerk_squared = 0;
+	bf->axes = 0;
+	for (uint8_t i=0; i<AXES; i++) {
+		if (fp_ZERO(unit[i])) { continue;}
+		jerk_squared += square(unit[i]) * cfg.a[i].jerk_max_squared;
+		bf->axes |= (1<<i);
 	}
-	if (fp_NOT_ZERO(diff = target[AXIS_A] - mm.position[AXIS_A])) { 
-		bf->unit[AXIS_A] = diff / length;
-		jerk_squared += square(bf->unit[AXIS_A] * cfg.a[AXIS_A].jerk_max);
+	bf->jerk = sqrt(jerk_squared);
+
+	for (uint8_t i=0; i<JERK_CACHE_SIZE; i++) {
+		if (fabs(bf->jerk - mm.jerk_cache[i].jerk) < JERK_MATCH_PRECISION) {	// can we re-use jerk terms?
+			MP_STAT(mps.jerk_hits++);
+			bf->cbrt_jerk = mm.jerk_cache[i].cbrt_jerk;
+			bf->recip_jerk = mm.jerk_cache[i].recip_jerk;
+			return;
+		}
 	}
-	if (fp_NOT_ZERO(diff = target[AXIS_B] - mm.position[AXIS_B])) { 
-		bf->unit[AXIS_B] = diff / length;
-		jerk_squared += square(bf->unit[AXIS_B] * cfg.a[AXIS_B].jerk_max);
+	MP_STAT(mps.jerk_misses++);
+	bf->cbrt_jerk = cbrt(bf->jerk);
+	bf->recip_jerk = 1/bf->jerk;
+	mpJerkTerms_t *jc = &mm.jerk_cache[mm.jerk_next];
+	jc->jerk = bf->jerk;
+	jc->cbrt_jerk = bf->cbrt_jerk;
+	jc->recip_jerk = bf->recip_jerk;
+	if (++mm.jerk_next >= JERK_CACHE_SIZE) { mm.jerk_next = 0;}
+}
+
+/*
+ * _get_cruise_vmax() - cruise velocity for a block at the overrides in effect
+ *
+ *	The block time is the time at the programmed feed rate. Feeds are sped up 
+ *	or slowed down by the feed rate override but never run faster than min_time,
+ *	the time the rate-limiting axis needs. Traverses already run at min_time
+ *	and are only slowed down, by the traverse override.
+ */
+static float _get_cruise_vmax(const mpBuf_t *bf)
+{
+	if (bf->motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE) {
+		if (mm.traverse_override_factor == 1) { return (bf->length / bf->time);}
+		return (bf->length * mm.traverse_override_factor / bf->time);
 	}
-	if (fp_NOT_ZERO(diff = target[AXIS_C] - mm.position[AXIS_C])) { 
-		bf->unit[AXIS_C] = diff / length;
-		jerk_squared += square(bf->unit[AXIS_C] * cfg.a[AXIS_C].jerk_max);
+	if (mm.feed_override_factor == 1) { return (bf->length / bf->time);}
+	return (bf->length / max((bf->time / mm.feed_override_factor), bf->min_time));
+}
+
+/*
+ * _get_prev_move() - return the block before bf, looking past any inline commands
+ *
+ *	Inline commands (mp_queue_inline_command()) are planned straight through, 
+ *	so the junction at the start of a line is with the block before them.
+ */
+static mpBuf_t *_get_prev_move(mpBuf_t *bf)
+{
+	mpBuf_t *bp = bf->pv;
+
+	while ((bp->move_type == MOVE_TYPE_INLINE_COMMAND) && (bp != bf)) {
+		bp = bp->pv;
 	}
-	bf->jerk = sqrt(jerk_squared);
+	return (bp);
+}
 
-	if (fabs(bf->jerk - mm.prev_jerk) < JERK_MATCH_PRECISION) {	// can we re-use jerk terms?
-		bf->cbrt_jerk = mm.prev_cbrt_jerk;
-		bf->recip_jerk = mm.prev_recip_jerk;
-	} else {
-		bf->cbrt_jerk = cbrt(bf->jerk);
-		bf->recip_jerk = 1/bf->jerk;			
-		mm.prev_jerk = bf->jerk;
-		mm.prev_cbrt_jerk = bf->cbrt_jerk;
-		mm.prev_recip_jerk = bf->recip_jerk;
+/*
+ * _get_open_line() - return the last queued block if a new line may still change it
+ *
+ *	The block must be a replannable G1 feed that is at least two blocks from 
+ *	running, the model must be in G1 and continuous path mode (G64), and no 
+ *	feedhold may be in progress. Returns NULL otherwise.
+ */
+static mpBuf_t *_get_open_line(void)
+{
+	mpBuf_t *bf = mb.q->pv;						// last queued block
+
+	if ((cm.hold_state != FEEDHOLD_OFF) ||
+		(cm_get_model_motion_mode() != MOTION_MODE_STRAIGHT_FEED) ||
+		(cm_get_model_path_control() != PATH_CONTINUOUS)) {
+		return (NULL);
+	}
+	if ((bf->move_type != MOVE_TYPE_ALINE) || (bf->motion_mode != MOTION_MODE_STRAIGHT_FEED) ||
+		(bf->replannable == false) || (bf->buffer_state != MP_BUFFER_QUEUED) ||
+		(bf->pv->buffer_state != MP_BUFFER_QUEUED)) {
+		return (NULL);
 	}
+	return (bf);
+}
 
-	// finish up the current block variables
-	if (cm_get_model_path_control() != PATH_EXACT_STOP) { // exact stop cases already zeroed
-		bf->replannable = true;
-		exact_stop = 12345678;					// an arbitrarily large floating point number
+/*
+ * _coalesce_line() - extend the last queued line if the new line continues it
+ *
+ *	CAM output often breaks a straight cut into long runs of tiny, nearly 
+ *	collinear G1 moves, each of which would take a buffer and at least one 
+ *	segment. If the new line continues the last queued block at the same feed 
+ *	rate, that block is lengthened to the new target instead. Returns true if 
+ *	the line was taken; otherwise mp_aline() queues it as a new block.
+ *
+ *	The last queued block can be extended if it is open (see _get_open_line())
+ *	and shorter than COALESCE_TIME_MAX. A work offset change has already ended
+ *	the run with a work offset block. The new target must:
+ *
+ *	  - lie within half of cfg.coalesce_tolerance of the line the block started
+ *		along. Every point the run passed through is then within the tolerance 
+ *		of the chord that is actually cut.
+ *	  - move forward along that line
+ *	  - not tighten the junction the block is entered with, as the block before
+ *		may already be frozen at the old entry velocity (_plan_block_list() [Note 1])
+ *
+ *	The block reports the line number of the last line it took.
+ *	Setting $mc=0 turns coalescing off.
+ */
+static uint8_t _coalesce_line(const float target[], const float minutes, const float min_time)
+{
+	mpBuf_t *bf;
+	float unit[AXES];
+	float along = 0;
+	float deviation = 0;
+	uint8_t i;
+
+	if ((cfg.coalesce_tolerance < EPSILON) || ((bf = _get_open_line()) == NULL) ||
+		((bf->time + minutes) > COALESCE_TIME_MAX)) {
+		return (false);
+	}
+	float length = get_axis_vector_length(target, mm.position);
+	float feed_rate = bf->length / bf->time;
+	if (fabs(length / minutes - feed_rate) > (feed_rate * COALESCE_VELOCITY_MATCH)) {
+		return (false);
+	}
+	for (i=0; i<AXES; i++) {
+		along += (target[i] - mm.coalesce_start[i]) * mm.coalesce_unit[i];
+	}
+	if (along <= mm.coalesce_along) { return (false);}
+	for (i=0; i<AXES; i++) {
+		deviation += square(target[i] - mm.coalesce_start[i] - along * mm.coalesce_unit[i]);
+	}
+	if (deviation > square(cfg.coalesce_tolerance/2)) { return (false);}
+
+	length = get_axis_vector_length(target, mm.coalesce_start);
+	set_unit_vector(unit, target, mm.coalesce_start, length);
+	float junction_delta = JUNCTION_DELTA_UNKNOWN;
+	mpBuf_t *pv = _get_prev_move(bf);
+	if ((mp_is_aline(pv) == true) && 
+		(_get_junction_vmax(mm.coalesce_pv_unit, unit, &mm.coalesce_pv_delta, &junction_delta) < bf->entry_vmax)) {
+		return (false);
 	}
-	bf->cruise_vmax = bf->length / bf->time;	// target velocity requested
-	junction_velocity = _get_junction_vmax(bf->pv->unit, bf->unit);
-	bf->entry_vmax = min3(bf->cruise_vmax, junction_velocity, exact_stop);
+
+	bf->linenum = cm_get_model_linenum();
+	bf->time += minutes;
+	mp_add_planner_queue_ms(minutes * 60000);
+	bf->min_time += min_time;
+	bf->length = length;
+	copy_axis_vector(bf->target, target);
+	_set_jerk_terms(bf, unit);
+	bf->cruise_vmax = _get_cruise_vmax(bf);
 	bf->delta_vmax = _get_target_velocity(0, bf->length, bf);
-	bf->exit_vmax = min3(bf->cruise_vmax, (bf->entry_vmax + bf->delta_vmax), exact_stop);
+	bf->exit_vmax = min(bf->cruise_vmax, (bf->entry_vmax + bf->delta_vmax));
 	bf->braking_velocity = bf->delta_vmax;
 
 	uint8_t mr_flag = false;
-	_plan_block_list(bf, &mr_flag);				// replan block list and commit current block
-	copy_axis_vector(mm.position, bf->target);	// update planning position
-	mp_queue_write_buffer(MOVE_TYPE_ALINE);
+	_plan_block_list(bf, &mr_flag);				// replan block list with the longer block
+	copy_axis_vector(mm.position, target);
+	copy_axis_vector(mm.unit, unit);
+	mm.junction_delta = junction_delta;
+	mm.coalesce_along = along;
+	MP_STAT(mps.coalesced++);
+	return (true);
+}
+
+/*
+ * _blend_corner() - cut the corner between the last queued line and a new one (G64 P)
+ *
+ *	_get_junction_vmax() only sets how fast the path may turn through a vertex;
+ *	the path still goes through it, so a polyline of sharp corners slows down 
+ *	hard at every one. With a tolerance set by G64 P the corner is rounded 
+ *	instead by a circle tangent to both lines that passes within the tolerance
+ *	of the vertex. The circle is cut as up to BLEND_SEGMENTS_MAX short lines 
+ *	that are tangent to it, so the path never strays further from the vertex
+ *	than the circle does and each of its junctions turns by only a fraction of 
+ *	the corner. The blend lines are fed at min(F, sqrt($ja * R)), the velocity 
+ *	that holds the centripetal acceleration on the circle of radius R to the 
+ *	junction acceleration; the jerk limited planner takes it from there.
+ *
+ *	The last queued line is shortened to where the blend starts and the blend
+ *	lines are queued. Sets fraction to the part of the new line that is left for
+ *	the caller to queue, or 1 if the corner is not blended. It is not when:
+ *
+ *	  - the last queued line can not be changed (see _get_open_line())
+ *	  - the new line reverses the last one. The blend circle shrinks to nothing
+ *		and has no plane to lie in, so the corner is left as an exact stop.
+ *	  - the blend would not be BLEND_VELOCITY_GAIN faster than the junction 
+ *		velocity at the vertex. The path is slow for the whole blend but only 
+ *		momentarily at the vertex, so a blend that is barely faster loses time.
+ *		At the default settings this is a tolerance of about 1.7 x $xjd
+ *	  - the blend lines would be shorter than MIN_ARC_SEGMENT_TIME, as for arcs
+ *	  - there are not enough free buffers for the blend and the line
+ *
+ *	A blend takes at most half of either line so blends at both ends of a line
+ *	can not overlap. The last queued line must also still be able to stop from
+ *	the velocity it is entered with, as the block before it may already be 
+ *	frozen at that velocity (_plan_block_list() [Note 1]). The tolerance is 
+ *	scaled down to fit short lines.
+ */
+static stat_t _blend_corner(const float target[], const float length, const float minutes, const float min_time,
+							float *fraction)
+{
+	mpBuf_t *bf;
+	float entry_unit[AXES];				// direction of the last queued line
+	float normal[AXES];					// towards the center, perpendicular to entry_unit
+	float center[AXES];
+	float point[AXES];
+	float cosine = 0;
+	uint8_t i, j;
+
+	*fraction = 1;
+	if ((cm_get_model_path_tolerance() < EPSILON) || ((bf = _get_open_line()) == NULL)) { return (STAT_OK);}
+
+	set_unit_vector(normal, target, mm.position, length);	// unit vector of the new line, for now
+	float feed_rate = length / minutes;
+	float normal_delta = JUNCTION_DELTA_UNKNOWN;
+	float vertex_velocity = _get_junction_vmax(mm.unit, normal, &mm.junction_delta, &normal_delta);
+	if (vertex_velocity >= min(feed_rate, bf->cruise_vmax)) { return (STAT_OK);}
+
+	for (i=0; i<AXES; i++) {
+		cosine += mm.unit[i] * normal[i];
+	}
+	float angle = acos(max(cosine, -1));					// direction change at the vertex
+	uint8_t segments = min(BLEND_SEGMENTS_MAX, (uint8_t)ceil(angle / BLEND_SEGMENT_ANGLE));
+	float step = angle / (segments + 1);					// direction change at each blend junction
+	float half_cosine = cos(angle/2);
+	float sine = sin(angle);
+	if ((half_cosine < EPSILON) || (sine < EPSILON)) { return (STAT_OK);}	// a reversal - no blend circle
+	float radius = cm_get_model_path_tolerance() * half_cosine / (1 - half_cosine);
+	float cut = radius * (tan(angle/2) - tan(step/2));		// length the blend takes from each line
+
+	float fit = min4(cut, bf->length/2, length/2, bf->length - _get_target_length(0, bf->entry_velocity, bf));
+	if (fit < MIN_LENGTH_MOVE) { return (STAT_OK);}
+	radius *= fit / cut;
+	cut = fit;
+	float chord = 2 * radius * tan(step/2);					// length of each blend line
+	float centripetal_velocity = sqrt(radius * cfg.junction_acceleration);
+	float velocity = min(feed_rate, centripetal_velocity);
+	if ((velocity < (vertex_velocity * BLEND_VELOCITY_GAIN)) || ((chord / velocity) < MIN_ARC_SEGMENT_TIME) ||
+		(mp_get_planner_buffers_available() < (segments + 1))) {
+		return (STAT_OK);
+	}
+
+	// end the last queued line where the blend starts
+	float tangent = radius * tan(angle/2);					// vertex to where the circle touches the lines
+	for (i=0; i<AXES; i++) {
+		entry_unit[i] = mm.unit[i];
+		normal[i] = (normal[i] - cosine * entry_unit[i]) / sine;
+		center[i] = mm.position[i] + (radius * normal[i]) - (tangent * entry_unit[i]);
+		bf->target[i] = mm.position[i] - (cut * entry_unit[i]);
+	}
+	float kept = (bf->length - cut) / bf->length;
+	bf->length -= cut;
+	mp_add_planner_queue_ms(-bf->time * (1 - kept) * 60000);
+	bf->time *= kept;
+	bf->min_time *= kept;
+	bf->delta_vmax = _get_target_velocity(0, bf->length, bf);
+	bf->exit_vmax = min(bf->cruise_vmax, (bf->entry_vmax + bf->delta_vmax));
+	bf->braking_velocity = bf->delta_vmax;
+	copy_axis_vector(mm.position, bf->target);
+
+	// queue the blend lines. Their ends are the corners of a polygon around the circle
+	float reach = radius / cos(step/2);
+	float theta = step/2;
+	for (j=0; j<segments; j++) {
+		theta += step;
+		float along = reach * sin(theta);
+		float across = reach * cos(theta);
+		for (i=0; i<AXES; i++) {
+			point[i] = center[i] + (along * entry_unit[i]) - (across * normal[i]);
+		}
+		stat_t status = _queue_aline(point, (chord / velocity), max((min_time * chord / length), (chord / centripetal_velocity)));
+		if (status != STAT_OK) { return (status);}	// buffers were checked above - never supposed to fail
+	}
+	MP_STAT(mps.blended++);
+	*fraction = (length - cut) / length;
 	return (STAT_OK);
 }
 
@@ -219,6 +747,7 @@ stat_t mp_aline(const float target[], const float minutes, const float work_offs
  * _get_target_length()
  * _get_target_velocity()
  * _get_junction_vmax()
+ * _get_junction_delta()
  * _reset_replannable_list()
  */
 
@@ -234,6 +763,8 @@ stat_t mp_aline(const float target[], const float minutes, const float work_offs
  *	  bf->move_type			- typically ALINE. Other move_types should be set to 
  *							  length=0, entry_vmax=0 and exit_vmax=0 and are treated
  *							  as a momentary hold (plan to zero and from zero).
+ *							  INLINE_COMMANDs are length=0 with unlimited vmax's and 
+ *							  pass the velocity straight through. No trapezoid.
  *
  *	  bf->length			- provides block length
  *	  bf->entry_vmax		- used during forward planning to set entry velocity
@@ -260,7 +791,6 @@ stat_t mp_aline(const float target[], const float minutes, const float work_offs
  *	Variables that are ignored but here's what you would expect them to be:
  *	  bf->move_state		- NEW for all blocks but the earliest
  *	  bf->target[]			- block target position
- *	  bf->unit[]			- block unit vector
  *	  bf->time				- gets set later
  *	  bf->jerk				- source of the other jerk variables. Used in mr.
  */
@@ -277,20 +807,40 @@ stat_t mp_aline(const float target[], const float minutes, const float work_offs
  *		These routines also set all blocks in the list to be replannable so the 
  *		list can be recomputed regardless of exact stops and previous replanning 
  *		optimizations.
+ *
+ *	[2]	The backward pass stops early once the plan has converged. If a block's
+ *		new braking velocity is bit-for-bit the one it already had then nothing
+ *		it passes back has changed, so every block before it would be planned
+ *		exactly as it was last time. That block is still replanned (its own exit
+ *		depends on the block after it) but the blocks before it are left alone.
+ *		In steady streaming the replannable flags usually end the pass first;
+ *		this catches lists that have been reset to replannable, as after a
+ *		feedhold. It is not used when mr_flag is set: the feedhold caller has
+ *		changed the front of the list and needs the whole list replanned.
  */
 static void _plan_block_list(mpBuf_t *bf, uint8_t *mr_flag)
 {
 	mpBuf_t *bp = bf;
+	float braking_velocity;
 
 	// Backward planning pass. Find beginning of the list and update the braking velocities.
-	// At the end *bp points to the first buffer before the list.
+	// At the end *bp points to the first buffer before the list. [Note 2]
 	while ((bp = mp_get_prev_buffer(bp)) != bf) {
+		MP_STAT(mps.plan_visits++);
 		if (bp->replannable == false) { break; }
-		bp->braking_velocity = min(bp->nx->entry_vmax, bp->nx->braking_velocity) + bp->delta_vmax;
+		braking_velocity = min(bp->nx->entry_vmax, bp->nx->braking_velocity) + bp->delta_vmax;
+		if ((braking_velocity == bp->braking_velocity) && (*mr_flag == false)) {
+			MP_STAT(mps.plan_converged++);
+			bp = bp->pv;					// plan converged - earlier blocks are unchanged
+			break;
+		}
+		bp->braking_velocity = braking_velocity;
 	}
 
 	// forward planning pass - recomputes trapezoids in the list.
 	while ((bp = mp_get_next_buffer(bp)) != bf) {
+		MP_STAT(mps.plan_visits++);
+		MP_STAT(mps.plan_replans++);
 		if ((bp->pv == bf) || (*mr_flag == true))  {
 			bp->entry_velocity = bp->entry_vmax;		// first block in the list
 			*mr_flag = false;
@@ -300,7 +850,9 @@ static void _plan_block_list(mpBuf_t *bf, uint8_t *mr_flag)
 		bp->cruise_velocity = bp->cruise_vmax;
 		bp->exit_velocity = min4(bp->exit_vmax, bp->nx->braking_velocity, bp->nx->entry_vmax,
 								(bp->entry_velocity + bp->delta_vmax));
-		_calculate_trapezoid(bp);
+		if (bp->move_type != MOVE_TYPE_INLINE_COMMAND) {
+			_calculate_trapezoid(bp);
+		}
 
 		// test for optimally planned trapezoids - only need to check various exit conditions
 		if ((bp->exit_velocity == bp->exit_vmax) || (bp->exit_velocity == bp->nx->entry_vmax) || 
@@ -309,10 +861,17 @@ static void _plan_block_list(mpBuf_t *bf, uint8_t *mr_flag)
 		}
 	}
 	// finish up the last block move
-	bp->entry_velocity = bp->pv->exit_velocity;
+	MP_STAT(mps.plan_replans++);
+	if (*mr_flag == true) {
+		bp->entry_velocity = bp->entry_vmax;		// last block is also the first
+	} else {
+		bp->entry_velocity = bp->pv->exit_velocity;
+	}
 	bp->cruise_velocity = bp->cruise_vmax;
 	bp->exit_velocity = 0;
-	_calculate_trapezoid(bp);
+	if (bp->move_type != MOVE_TYPE_INLINE_COMMAND) {
+		_calculate_trapezoid(bp);
+	}
 }
 
 /*
@@ -385,7 +944,7 @@ static void _reset_replannable_list()
  *
  *	  Rate-Limited cases - Ve and Vx can be satisfied but Vt cannot
  *	  	HT	(Ve=Vx)<Vt	symmetric case. Split the length and compute Vt.
- *	  	HT'	(Ve!=Vx)<Vt	asymmetric case. Find H and T by successive approximation.
+ *	  	HT'	(Ve!=Vx)<Vt	asymmetric case. Solve for Vt by Newton's method, then H and T.
  *		HBT'			Lb < min body length - treated as an HT case
  *		H'				Lb < min body length - reduce J to fit H to length
  *		T'				Lb < min body length - reduce J to fit T to length
@@ -411,6 +970,7 @@ static void _reset_replannable_list()
 
 static void _calculate_trapezoid(mpBuf_t *bf) 
 {
+	MP_STAT(mps.trapezoids++);
 	bf->head_length = 0;		// inialize the lengths
 	bf->body_length = 0;
 	bf->tail_length = 0;
@@ -466,26 +1026,33 @@ static void _calculate_trapezoid(mpBuf_t *bf)
 			bf->head_length = bf->length/2;
 			bf->tail_length = bf->head_length;
 			bf->cruise_velocity = min(bf->cruise_vmax, _get_target_velocity(bf->entry_velocity, bf->head_length, bf));
+			if (bf->head_length < MIN_HEAD_LENGTH) {	// too short for 2 segment halves - run it as a body
+				bf->head_length = 0;
+				bf->tail_length = 0;
+				bf->body_length = bf->length;
+				bf->cruise_velocity = bf->entry_velocity;
+			}
 			return;
 		}
 
-		// Rate-limited HT' case (asymmetric) - this is relatively expensive but it's not called very often
-		float computed_velocity = bf->cruise_vmax;
+		// Rate-limited HT' case (asymmetric) - solve Lh(Vt) + Lt(Vt) = L for Vt by Newton's method
+		// Each side is dV*sqrt(dV/Jm), so the sum is convex and increasing in Vt with a derivative
+		// of 1.5*(sqrt(dVh/Jm) + sqrt(dVt/Jm)). Starting at cruise_vmax (above the root) the steps 
+		// approach from above and converge quadratically - about 4 steps to the length tolerance.
+		float velocity = bf->cruise_vmax;
+		float head_dv, tail_dv, head_time, tail_time, length_error;
 		uint8_t i=0;
+		MP_STAT(mps.ht_asymmetric++);
 		do {
-			bf->cruise_velocity = computed_velocity;	// initialize from previous iteration 
-			bf->head_length = _get_target_length(bf->entry_velocity, bf->cruise_velocity, bf);
-			bf->tail_length = _get_target_length(bf->exit_velocity, bf->cruise_velocity, bf);
-			if (bf->head_length > bf->tail_length) {
-				bf->head_length = (bf->head_length / (bf->head_length + bf->tail_length)) * bf->length;
-				computed_velocity = _get_target_velocity(bf->entry_velocity, bf->head_length, bf);
-			} else {
-				bf->tail_length = (bf->tail_length / (bf->head_length + bf->tail_length)) * bf->length;
-				computed_velocity = _get_target_velocity(bf->exit_velocity, bf->tail_length, bf);
-			}
-			if (++i > TRAPEZOID_ITERATION_MAX) { fprintf_P(stderr,PSTR("_calculate_trapezoid() failed to converge"));}
-		} while ((fabs(bf->cruise_velocity - computed_velocity) / computed_velocity) > TRAPEZOID_ITERATION_ERROR_PERCENT);
-		bf->cruise_velocity = computed_velocity;
+			MP_STAT(mps.ht_iterations++);
+			head_dv = fabs(velocity - bf->entry_velocity);
+			tail_dv = fabs(velocity - bf->exit_velocity);
+			head_time = sqrt(head_dv * bf->recip_jerk);	// half the head time (see _get_target_length())
+			tail_time = sqrt(tail_dv * bf->recip_jerk);
+			length_error = (head_dv * head_time) + (tail_dv * tail_time) - bf->length;
+			velocity -= length_error / (1.5 * (head_time + tail_time));
+		} while ((fabs(length_error) > TRAPEZOID_LENGTH_FIT_TOLERANCE) && (++i < TRAPEZOID_ITERATION_MAX));
+		bf->cruise_velocity = velocity;
 		bf->head_length = _get_target_length(bf->entry_velocity, bf->cruise_velocity, bf);
 		bf->tail_length = bf->length - bf->head_length;
 		if (bf->head_length < MIN_HEAD_LENGTH) {
@@ -569,6 +1136,13 @@ static void _calculate_trapezoid(mpBuf_t *bf)
  *
  *  FYI: Here's an expression that returns the jerk for a given deltaV and L:
  * 	return(cube(deltaV / (pow(L, 0.66666666))));
+ *
+ *	The roots stay in float. Taking them in fixed point (the mantissa root of a
+ *	frexp() split, as integer shifts and Newton steps) was tried and dropped: it
+ *	planned the corpus within 0.026% of this in time, but there are no xmega
+ *	cycle counts to show a saving, avr-libc's sqrt() is already hand-written 
+ *	asm, and on the host it planned about 5x slower. sim/equiv.sh remains for 
+ *	comparing a planner change against a reference build.
  */
 
 static float _get_target_length(const float Vi, const float Vt, const mpBuf_t *bf)
@@ -693,8 +1267,13 @@ static float _get_target_velocity(const float Vi, const float L, const mpBuf_t *
  *	 	U[i]	Unit sum of i'th axis	fabs(unit_a[i]) + fabs(unit_b[i])
  *	 	Usum	Length of sums			Ux + Uy
  *	 	d		Delta of sums			(Dx*Ux+DY*UY)/Usum
+ *
+ *	The fused delta of each line is passed in by reference. It is computed only if the
+ *	junction is a corner, and kept so the next junction can re-use it: the exit line 
+ *	of one junction is the entry line of the next. JUNCTION_DELTA_UNKNOWN means it has 
+ *	not been computed yet.
  */
-static float _get_junction_vmax(const float a_unit[], const float b_unit[])
+static float _get_junction_vmax(const float a_unit[], const float b_unit[], float *a_delta, float *b_delta)
 {
 	float costheta = - (a_unit[AXIS_X] * b_unit[AXIS_X]) - (a_unit[AXIS_Y] * b_unit[AXIS_Y]) 
 					  - (a_unit[AXIS_Z] * b_unit[AXIS_Z]) - (a_unit[AXIS_A] * b_unit[AXIS_A]) 
@@ -704,26 +1283,28 @@ static float _get_junction_vmax(const float a_unit[], const float b_unit[])
 	if (costheta > 0.99)  { return (0); } 				// reversal cases
 
 	// Fuse the junction deviations into a vector sum
-	float a_delta = square(a_unit[AXIS_X] * cfg.a[AXIS_X].junction_dev);
-	a_delta += square(a_unit[AXIS_Y] * cfg.a[AXIS_Y].junction_dev);
-	a_delta += square(a_unit[AXIS_Z] * cfg.a[AXIS_Z].junction_dev);
-	a_delta += square(a_unit[AXIS_A] * cfg.a[AXIS_A].junction_dev);
-	a_delta += square(a_unit[AXIS_B] * cfg.a[AXIS_B].junction_dev);
-	a_delta += square(a_unit[AXIS_C] * cfg.a[AXIS_C].junction_dev);
-
-	float b_delta = square(b_unit[AXIS_X] * cfg.a[AXIS_X].junction_dev);
-	b_delta += square(b_unit[AXIS_Y] * cfg.a[AXIS_Y].junction_dev);
-	b_delta += square(b_unit[AXIS_Z] * cfg.a[AXIS_Z].junction_dev);
-	b_delta += square(b_unit[AXIS_A] * cfg.a[AXIS_A].junction_dev);
-	b_delta += square(b_unit[AXIS_B] * cfg.a[AXIS_B].junction_dev);
-	b_delta += square(b_unit[AXIS_C] * cfg.a[AXIS_C].junction_dev);
-
-	float delta = (sqrt(a_delta) + sqrt(b_delta))/2;
+	if (*a_delta < 0) { *a_delta = _get_junction_delta(a_unit);}
+	if (*b_delta < 0) { *b_delta = _get_junction_delta(b_unit);}
+
+	float delta = (*a_delta + *b_delta)/2;
 	float sintheta_over2 = sqrt((1 - costheta)/2);
 	float radius = delta * sintheta_over2 / (1-sintheta_over2);
 	return(sqrt(radius * cfg.junction_acceleration));
 }
 
+/*
+ * _get_junction_delta() - fuse the axis junction deviations for a line's unit vector
+ */
+static float _get_junction_delta(const float unit[])
+{
+	float delta_squared = 0;
+	for (uint8_t i=0; i<AXES; i++) {
+		if (fp_ZERO(unit[i])) { continue;}
+		delta_squared += square(unit[i]) * cfg.a[i].junction_dev_squared;
+	}
+	return (sqrt(delta_squared));
+}
+
 /*************************************************************************
  * feedholds - functions for performing holds
  *
@@ -745,12 +1326,20 @@ static float _get_junction_vmax(const float a_unit[], const float b_unit[])
  *		time to replan the block list for the hold before the next aline 
  *		segment needs to be processed.
  *
- *	  - Hold state == PLAN tells the planner to replan the mr buffer, the current
- *		run buffer (bf), and any subsequent bf buffers as necessary to execute a
- *		hold. Hold planning replans the planner buffer queue down to zero and then
- *		back up from zero. Hold state is set to DECEL when planning is complete.
+ *	  - Hold state == PLAN tells the planner to replan the mr buffer, and any 
+ *		bf buffers the deceleration runs on into, to execute a hold. It starts 
+ *		from the velocity of the next segment mr will run. Only the blocks 
+ *		within braking distance are touched, so the cost is bounded by how far 
+ *		the machine takes to stop, not by how much is queued. Hold state is set
+ *		to DECEL when the deceleration is planned.
+ *
+ *	  - The blocks after the hold point are replanned back up from zero on the 
+ *		next pass of mp_plan_hold_callback() (mm.hold_replan). They can't run
+ *		until the hold is over, so this is off the path to the deceleration.
+ *		Only the blocks whose plan changes are replanned - usually the hold 
+ *		point pair - so the rest of the queue keeps its plan for the resume.
  *
- *	  - Hold state == DECEL persists until the aline execution gets runs to 
+ *	  - Hold state == DECEL persists until the aline execution runs a move to 
  *		zero velocity, at which point hold state transitions to HOLD.
  *
  *	  - Hold state == HOLD persists until the cycle is restarted. A cycle start 
@@ -774,6 +1363,7 @@ static float _get_junction_vmax(const float a_unit[], const float b_unit[])
  *		buffer to split the move in two where the hold decelerates to zero. Use 
  *		one buffer to go to zero, the other to replan up from zero. All buffers past
  *		that point are unaffected other than that they need to be replanned for velocity.  
+ *		A hold that lands between blocks starts the next block in mr first.
  *
  *	Note: There are multiple opportunities for more efficient organization of 
  *		  code in this module, but the code is so complicated I just left it
@@ -782,47 +1372,58 @@ static float _get_junction_vmax(const float a_unit[], const float b_unit[])
 
 stat_t mp_plan_hold_callback()
 {
-	if (cm.hold_state != FEEDHOLD_PLAN) { return (STAT_NOOP);}	// not planning a feedhold
+	if (cm.hold_state != FEEDHOLD_PLAN) { return (_plan_hold_queue());}	// not planning a feedhold
 
 	mpBuf_t *bp; 					// working buffer pointer
 	if ((bp = mp_get_run_buffer()) == NULL) { return (STAT_NOOP);}	// Oops! nothing's running
 
-	uint8_t mr_flag = true;		// used to tell replan to account for mr buffer Vx
 	float mr_available_length; // available length left in mr buffer for deceleration
 	float braking_velocity;	// velocity left to shed to brake to zero
 	float braking_length;		// distance required to brake to zero from braking_velocity
 
-	// examine and process mr buffer
-	mr_available_length = get_axis_vector_length(mr.endpoint, mr.position);
-
-/*	mr_available_length = 
-		(sqrt(square(mr.endpoint[AXIS_X] - mr.position[AXIS_X]) +
-			  square(mr.endpoint[AXIS_Y] - mr.position[AXIS_Y]) +
-			  square(mr.endpoint[AXIS_Z] - mr.position[AXIS_Z]) +
-			  square(mr.endpoint[AXIS_A] - mr.position[AXIS_A]) +
-			  square(mr.endpoint[AXIS_B] - mr.position[AXIS_B]) +
-			  square(mr.endpoint[AXIS_C] - mr.position[AXIS_C])));
-*/
+	// Between blocks: mr has run out. If it stopped it only has to stay stopped.
+	// Otherwise start the next block in mr now so it can be replanned like any other.
+	if (mr.move_state == MOVE_STATE_OFF) {
+		if (fp_ZERO(mr.exit_velocity)) {
+			mr.move_state = MOVE_STATE_TAIL;	// an empty tail holds at the next exec
+			mr.section_state = MOVE_STATE_NEW;
+			mr.tail_length = 0;
+			cm.hold_state = FEEDHOLD_DECEL;
+			return (STAT_OK);
+		}
+		if ((mp_is_aline(bp) == false) || (fp_ZERO(bp->length))) {
+			return (STAT_NOOP);					// try again once the next line is running
+		}
+		mr.preload_state = PRELOAD_OFF;
+		bp->replannable = false;
+		bp->move_state = MOVE_STATE_RUN;
+		MP_STAT(mps.boundaries++);
+		_load_aline(&mr, bp);
+	}
+	MP_STAT(mps.holds++);
+	mr.preload_state = PRELOAD_OFF;	// the blocks after mr are replanned below
+	mr_available_length = _get_runtime_length(&mr);
 	braking_velocity = _compute_next_segment_velocity();
 	braking_length = _get_target_length(braking_velocity, 0, bp); // bp is OK to use here
-	
-	// Hack to prevent Case 2 moves for perfect-fit decels. Happens in homing situations
-	// The real fix: The braking velocity cannot simply be the mr.segment_velocity as this
-	// is the velocity of the last segment, not the one that's going to be executed next.
-	// The braking_velocity needs to be the velocity of the next segment that has not yet 
-	// been computed. In the mean time, this hack will work. 
-	if ((braking_length > mr_available_length) && (fp_ZERO(bp->exit_velocity))) {
-		braking_length = mr_available_length;
-	}
-
-	// Case 1: deceleration fits entirely in mr
-	if (braking_length <= mr_available_length) {
+
+	// Case 0: mr already decelerates to zero and can't stop any sooner. Let it run out.
+	if (fp_ZERO(mr.exit_velocity) && 
+		((mr.move_state == MOVE_STATE_TAIL) || (braking_length >= mr_available_length))) {
+		cm.hold_state = FEEDHOLD_DECEL;
+		return (STAT_OK);
+	}
+
+	// Case 1: deceleration fits entirely in mr. A stop that only overshoots by 
+	// rounding (as in a perfect-fit decel) fits - it is run a hair short.
+	if (braking_length <= (mr_available_length * (1 + HOLD_LENGTH_FIT_TOLERANCE))) {
 		// set mr to a tail to perform the deceleration
+		braking_length = min(braking_length, mr_available_length);
 		mr.exit_velocity = 0;
 		mr.tail_length = braking_length;
 		mr.cruise_velocity = braking_velocity;
 		mr.move_state = MOVE_STATE_TAIL;
 		mr.section_state = MOVE_STATE_NEW;
+		mr.endpoint_theta = _get_runtime_point(&mr, braking_length, mr.endpoint);	// end the tail where bp+0 takes over
 
 		// re-use bp+0 to be the hold point and to draw the remaining length
 		bp->length = mr_available_length - braking_length;
@@ -830,8 +1431,7 @@ stat_t mp_plan_hold_callback()
 		bp->entry_vmax = 0;						// set bp+0 as hold point
 		bp->move_state = MOVE_STATE_NEW;		// tell _exec to re-use the bf buffer
 
-		_reset_replannable_list();				// make it replan all the blocks
-		_plan_block_list(mp_get_last_buffer(), &mr_flag);
+		mm.hold_replan = bp;					// replan from bp+0 on the next pass
 		cm.hold_state = FEEDHOLD_DECEL;			// set state to decelerate and exit
 		return (STAT_OK);
 	}
@@ -846,20 +1446,23 @@ stat_t mp_plan_hold_callback()
 	mr.exit_velocity = braking_velocity - _get_target_velocity(0, mr_available_length, bp);	
 
 	// Find the point where deceleration reaches zero. This could span multiple buffers.
+	// Each buffer it runs through is set up as a tail to the velocity it reaches.
 	braking_velocity = mr.exit_velocity;		// adjust braking velocity downward
+	float *start = mr.endpoint;					// where the block being planned starts
 	bp->move_state = MOVE_STATE_NEW;			// tell _exec to re-use buffer
 	for (uint8_t i=0; i<PLANNER_BUFFER_POOL_SIZE; i++) {// a safety to avoid wraparound
 		mp_copy_buffer(bp, bp->nx);				// copy bp+1 into bp+0 (and onward...)
-		if (bp->move_type != MOVE_TYPE_ALINE) {	// skip any non-move buffers
+		if (mp_is_aline(bp) == false) {			// skip any non-move buffers
 			bp = mp_get_next_buffer(bp);		// point to next buffer
 			continue;
 		}
-		bp->entry_vmax = braking_velocity;		// velocity we need to shed
 		braking_length = _get_target_length(braking_velocity, 0, bp);
 
-		if (braking_length > bp->length) {		// decel does not fit in bp buffer
-			bp->exit_vmax = braking_velocity - _get_target_velocity(0, bp->length, bp);
-			braking_velocity = bp->exit_vmax;	// braking velocity for next buffer
+		if ((braking_length > (bp->length * (1 + HOLD_LENGTH_FIT_TOLERANCE))) &&	// decel does not fit in bp...
+			(bp->nx->nx->buffer_state != MP_BUFFER_EMPTY)) {	// ...and it isn't the last one
+			_plan_hold_tail(bp, braking_velocity, braking_velocity - _get_target_velocity(0, bp->length, bp));
+			braking_velocity = bp->exit_velocity;	// braking velocity for next buffer
+			start = bp->target;
 			bp = mp_get_next_buffer(bp);		// point to next buffer
 			continue;
 		}
@@ -867,25 +1470,116 @@ stat_t mp_plan_hold_callback()
 	}
 	// Deceleration now fits in the current bp buffer
 	// Plan the first buffer of the pair as the decel, the second as the accel
+	// Split the time too, so the pair adds up to the one buffer in mm.ms_in_queue
+	// The decel ends at the hold point, not at the target (the runtime runs to it)
+	braking_length = min(braking_length, bp->length);
+	float fraction = braking_length / bp->length;
+	float center_1 = 0;
+	float center_2 = 0;
+	if (bp->move_type == MOVE_TYPE_ARC) { _get_arc_center(bp, &center_1, &center_2);}
+	for (uint8_t i=0; i<AXES; i++) {
+		bp->target[i] = start[i] + ((bp->target[i] - start[i]) * fraction);
+	}
+	if (bp->move_type == MOVE_TYPE_ARC) {		// an arc ends on the arc
+		bp->theta -= bp->angular_rate * (bp->length - braking_length);
+		bp->target[bp->axis_1] = center_1 + (sin(bp->theta) * bp->radius);
+		bp->target[bp->axis_2] = center_2 + (cos(bp->theta) * bp->radius);
+	}
+	bp->time *= fraction;
+	bp->min_time *= fraction;
 	bp->length = braking_length;
-	bp->exit_vmax = 0;
+	_plan_hold_tail(bp, braking_velocity, 0);
 
 	bp = mp_get_next_buffer(bp);				// point to the acceleration buffer
 	bp->entry_vmax = 0;
 	bp->length -= braking_length;				// the buffers were identical (and hence their lengths)
+	bp->time -= bp->pv->time;
+	bp->min_time -= bp->pv->min_time;
 	bp->delta_vmax = _get_target_velocity(0, bp->length, bp);
 	bp->exit_vmax = bp->delta_vmax;
 
-	_reset_replannable_list();					// make it replan all the blocks
-	_plan_block_list(mp_get_last_buffer(), &mr_flag);
+	mm.hold_replan = bp;						// replan from the acceleration buffer on the next pass
 	cm.hold_state = FEEDHOLD_DECEL;				// set state to decelerate and exit
 	return (STAT_OK);
 }
 
+/*
+ * _plan_hold_tail() - plan a block of the hold deceleration as a tail
+ *
+ *	The block decelerates over its whole length, so there is nothing to work out. 
+ *	It is taken out of replanning so nothing can change it before it runs.
+ */
+static void _plan_hold_tail(mpBuf_t *bf, const float entry_velocity, const float exit_velocity)
+{
+	MP_STAT(mps.hold_blocks++);
+	bf->entry_vmax = entry_velocity;
+	bf->exit_vmax = exit_velocity;
+	bf->entry_velocity = entry_velocity;
+	bf->cruise_velocity = entry_velocity;
+	bf->exit_velocity = exit_velocity;
+	bf->head_length = 0;
+	bf->body_length = 0;
+	bf->tail_length = bf->length;
+	bf->replannable = false;
+}
+
+/*
+ * _plan_hold_queue() - replan the blocks behind the hold point
+ *
+ *	The hold point block now starts from zero (its entry_vmax) instead of the 
+ *	velocity it was planned to enter at. The blocks after it were planned to follow
+ *	on from that, and a plan that exits no faster than before is still a valid plan
+ *	for them, so only a forward pass is needed: each block exits at the lesser of 
+ *	its old exit and what it can reach from its new entry. The pass stops after the
+ *	first block that still reaches its old exit and the rest of the queue keeps the
+ *	plan it had. That is usually the hold point block or the one after it, so the 
+ *	cost does not grow with the queue and the hold can be resumed at once.
+ *
+ *	None of these blocks can run until the hold is over, so this is left for the 
+ *	pass after the hold was planned. A block that now exits as fast as it can from
+ *	a block that won't change is optimally planned, as in _plan_block_list().
+ */
+static stat_t _plan_hold_queue()
+{
+	if (mm.hold_replan == NULL) { return (STAT_NOOP);}
+
+	mpBuf_t *bp = mm.hold_replan;
+	float entry_velocity = bp->entry_vmax;		// zero, from the hold point
+	float exit_velocity;
+
+	for (uint8_t i=0; i<PLANNER_BUFFER_POOL_SIZE; i++) {// a safety to avoid wraparound
+		MP_STAT(mps.hold_queue_blocks++);
+		exit_velocity = bp->exit_velocity;		// the exit it was planned to
+		bp->entry_velocity = entry_velocity;
+		bp->cruise_velocity = bp->cruise_vmax;
+		bp->exit_velocity = min(exit_velocity, (entry_velocity + bp->delta_vmax));
+		if (bp->move_type != MOVE_TYPE_INLINE_COMMAND) {
+			_calculate_trapezoid(bp);
+		}
+		if (bp->exit_velocity == exit_velocity) { break;}	// the blocks after it are unchanged
+		if ((bp->pv->replannable == false) && (bp->exit_velocity == (bp->entry_velocity + bp->delta_vmax))) {
+			bp->replannable = false;
+		}
+		entry_velocity = bp->exit_velocity;
+		if ((bp = mp_get_next_buffer(bp))->move_state == MOVE_STATE_OFF) { break;}
+	}
+	mm.hold_replan = NULL;
+	return (STAT_OK);
+}
+
+/*
+ * _compute_next_segment_velocity() - velocity of the next segment mr will run
+ *
+ *	forward_diff_1 is the length of the next segment, so a running section gives
+ *	its average velocity exactly. A section that has not started yet starts at the
+ *	head's entry velocity, or at cruise velocity for a body or tail.
+ */
 static float _compute_next_segment_velocity()
 {
-	if (mr.move_state == MOVE_STATE_BODY) { return (mr.segment_velocity);}
-	return (mr.segment_velocity + mr.forward_diff_1);
+	if (mr.section_state == MOVE_STATE_NEW) {
+		return ((mr.move_state == MOVE_STATE_HEAD) ? mr.entry_velocity : mr.cruise_velocity);
+	}
+	return (mr.forward_diff_1 / mr.segment_move_time);	// forward_diff_1 is the next segment's length
 }
 
 /*
@@ -907,6 +1601,147 @@ stat_t mp_end_hold()
 }
 
 
+/*************************************************************************
+ * feed rate override - functions for replanning to a new feed rate
+ *
+ * mp_feed_rate_override() - set the feed override factor and request a replan
+ * mp_traverse_override() - set the traverse override factor and request a replan
+ * mp_plan_override_callback() - replan the running block and the queue
+ *
+ *	Overrides are applied by _get_cruise_vmax(), so lines queued after one 
+ *	changes pick it up as they are planned. Lines already queued and the 
+ *	move that is running are replanned in the same way as a feedhold:
+ *
+ *	  - mp_feed_rate_override() sets mr.feed_override_state to SYNC
+ *
+ *	  - SYNC tells the aline exec routine to set the state to PLAN once it has
+ *		prepped the next segment, which leaves a segment time for the replan.
+ *		A feedhold in progress holds the override in SYNC until it is over.
+ *
+ *	  - mp_plan_override_callback() runs from the main loop in PLAN. It sets
+ *		new cruise velocities in the running block and every queued line and 
+ *		replans the whole list from the velocity of the next segment. If the 
+ *		override slows the move down, mr first decelerates to the new velocity
+ *		as a tail and bp+0 is re-used to draw the rest of the move, as in 
+ *		hold Case 1. Otherwise mr is loaded with the replanned bp+0 directly.
+ *		Either way the next segment starts at zero acceleration.
+ *
+ *	  - If the running move is too close to its end to replan (or nothing is 
+ *		running yet) the state goes back to SYNC and the next segment tries 
+ *		again. Nothing is changed until the replan is done.
+ */
+
+stat_t mp_feed_rate_override(uint8_t flag, float parameter)
+{
+	float factor = 1;
+
+	if (flag == true) {
+		factor = min(max(parameter, FEED_OVERRIDE_MIN), FEED_OVERRIDE_MAX);
+	}
+	if (factor == mm.feed_override_factor) { return (STAT_NOOP);}
+	mm.feed_override_factor = factor;
+	mr.feed_override_state = FEED_OVERRIDE_SYNC;
+	return (STAT_OK);
+}
+
+stat_t mp_traverse_override(uint8_t flag, float parameter)
+{
+	float factor = 1;
+
+	if (flag == true) {
+		factor = min(max(parameter, TRAVERSE_OVERRIDE_MIN), 1);
+	}
+	if (factor == mm.traverse_override_factor) { return (STAT_NOOP);}
+	mm.traverse_override_factor = factor;
+	mr.feed_override_state = FEED_OVERRIDE_SYNC;
+	return (STAT_OK);
+}
+
+stat_t mp_plan_override_callback()
+{
+	if (mr.feed_override_state != FEED_OVERRIDE_PLAN) { return (STAT_NOOP);}
+	mr.feed_override_state = FEED_OVERRIDE_SYNC;	// try again next segment unless replanned below
+
+	mpBuf_t *bp; 					// bp+0, the companion to the mr buffer
+	if ((bp = mp_get_run_buffer()) == NULL) { 		// nothing queued - nothing to replan
+		mr.feed_override_state = FEED_OVERRIDE_OFF;
+		return (STAT_NOOP);
+	}
+	if ((cm.hold_state != FEEDHOLD_OFF) || (mp_is_aline(bp) == false) || 
+		(bp->move_state != MOVE_STATE_RUN) || (mr.move_state == MOVE_STATE_OFF) || 
+		(mr.move_state == MOVE_STATE_SKIP)) {
+		return (STAT_NOOP);
+	}
+
+	uint8_t mr_flag = true;			// used to tell replan to account for mr buffer Vx
+	float mr_available_length = _get_runtime_length(&mr);
+	float velocity = _compute_next_segment_velocity();
+	float cruise_velocity = _get_cruise_vmax(bp);	// length / time ratio is kept below
+	float braking_length = 0;
+
+	if (velocity > cruise_velocity) {
+		braking_length = _get_target_length(velocity, cruise_velocity, bp);
+		if (braking_length < (MIN_SEGMENT_TIME * (velocity + cruise_velocity))) {
+			braking_length = 0;						// too small to run as a tail - keep the velocity
+			cruise_velocity = velocity;
+		}
+	}
+	if ((mr_available_length - braking_length) < (2 * MIN_SEGMENT_TIME * max(velocity, cruise_velocity))) {
+		return (STAT_NOOP);							// too close to the end of the move
+	}
+
+	// set new velocity limits in the queued lines
+	mr.preload_state = PRELOAD_OFF;					// (drops any preloaded block)
+	mpBuf_t *bf = bp;
+	while (((bf = mp_get_next_buffer(bf)) != bp) && (bf->move_state != MOVE_STATE_OFF)) {
+		if (mp_is_aline(bf) == false) { continue;}
+		bf->cruise_vmax = _get_cruise_vmax(bf);
+		bf->entry_vmax = min(bf->cruise_vmax, bf->junction_vmax);
+		if (fp_NOT_ZERO(bf->exit_vmax)) {			// exact stops still exit at zero
+			bf->exit_vmax = min(bf->cruise_vmax, (bf->entry_vmax + bf->delta_vmax));
+		}
+	}
+
+	// re-use bp+0 for what is left of the move after any deceleration in mr
+	float fraction = (mr_available_length - braking_length) / bp->length;
+	bp->length *= fraction;
+	bp->time *= fraction;
+	bp->min_time *= fraction;
+	bp->cruise_vmax = cruise_velocity;
+	bp->entry_vmax = cruise_velocity;
+	bp->delta_vmax = _get_target_velocity(0, bp->length, bp);
+	if (fp_NOT_ZERO(bp->exit_vmax)) {
+		bp->exit_vmax = min(bp->cruise_vmax, (bp->entry_vmax + bp->delta_vmax));
+	}
+	if (fp_NOT_ZERO(braking_length)) {
+		mr.cruise_velocity = velocity;				// set mr to a tail down to the new velocity
+		mr.exit_velocity = cruise_velocity;
+		mr.tail_length = braking_length;
+		mr.move_state = MOVE_STATE_TAIL;
+		mr.section_state = MOVE_STATE_NEW;
+		mr.endpoint_theta = _get_runtime_point(&mr, braking_length, mr.endpoint);	// end the tail where bp+0 takes over
+		bp->move_state = MOVE_STATE_NEW;			// tell _exec to re-use the bf buffer
+	} else {
+		bp->entry_vmax = velocity;
+	}
+	_reset_replannable_list();						// make it replan all the blocks
+	_plan_block_list(mp_get_last_buffer(), &mr_flag);
+
+	if (fp_ZERO(braking_length)) {					// mr runs the replanned bp+0 from here
+		bp->move_state = MOVE_STATE_RUN;			// (a short bp+0 may have been marked to skip)
+		mr.head_length = bp->head_length;
+		mr.body_length = bp->body_length;
+		mr.tail_length = bp->tail_length;
+		mr.entry_velocity = bp->entry_velocity;
+		mr.cruise_velocity = bp->cruise_velocity;
+		mr.exit_velocity = bp->exit_velocity;
+		mr.move_state = MOVE_STATE_HEAD;
+		mr.section_state = MOVE_STATE_NEW;
+	}
+	mr.feed_override_state = FEED_OVERRIDE_OFF;
+	return (STAT_OK);
+}
+
 /*************************************************************************/
 /**** ALINE EXECUTION ROUTINES *******************************************/
 /*************************************************************************
@@ -989,7 +1824,7 @@ static stat_t _exec_aline(mpBuf_t *bf)
 
 	if (bf->move_state == MOVE_STATE_OFF) { return (STAT_NOOP);} 
 	if (mr.move_state == MOVE_STATE_OFF) {
-		if (cm.hold_state == FEEDHOLD_HOLD) { return (STAT_NOOP);}// stops here if holding
+		if ((cm.hold_state == FEEDHOLD_HOLD) || (mb.hold_pending == true)) { return (STAT_NOOP);}// stops here if holding
 
 		// initialization to process the new incoming bf buffer
 		bf->replannable = false;
@@ -1002,20 +1837,10 @@ static stat_t _exec_aline(mpBuf_t *bf)
 			return (STAT_NOOP);
 		}
 		bf->move_state = MOVE_STATE_RUN;
-		mr.move_state = MOVE_STATE_HEAD;
-		mr.section_state = MOVE_STATE_NEW;
-		mr.linenum = bf->linenum;
-		mr.motion_mode = bf->motion_mode;
-		mr.jerk = bf->jerk;
-		mr.head_length = bf->head_length;
-		mr.body_length = bf->body_length;
-		mr.tail_length = bf->tail_length;
-		mr.entry_velocity = bf->entry_velocity;
-		mr.cruise_velocity = bf->cruise_velocity;
-		mr.exit_velocity = bf->exit_velocity;
-		copy_axis_vector(mr.unit, bf->unit);
-		copy_axis_vector(mr.endpoint, bf->target);	// save the final target of the move
-		copy_axis_vector(mr.work_offset, bf->work_offset);// propagate offset
+		MP_STAT(mps.boundaries++);
+		if (_swap_in_preload(bf) == false) {		// preloaded during the last block?
+			_load_aline(&mr, bf);					// no - load it now
+		}
 	}
 	// NB: from this point on the contents of the bf buffer do not affect execution
 
@@ -1031,11 +1856,16 @@ static stat_t _exec_aline(mpBuf_t *bf)
 	// Catch the feedhold request and start the planning the hold
 	if (cm.hold_state == FEEDHOLD_SYNC) { cm.hold_state = FEEDHOLD_PLAN;}
 
-	// Look for the end of the decel to go into HOLD state
-	if ((cm.hold_state == FEEDHOLD_DECEL) && (status == STAT_OK)) {
-		cm.hold_state = FEEDHOLD_HOLD;
-		cm.motion_state = MOTION_HOLD;
-		rpt_request_status_report(SR_IMMEDIATE_REQUEST);
+	// Feed override processing. Same handshake as the feedhold (see mp_plan_override_callback())
+	if ((mr.feed_override_state == FEED_OVERRIDE_SYNC) && (cm.hold_state == FEEDHOLD_OFF)) {
+		mr.feed_override_state = FEED_OVERRIDE_PLAN;
+	}
+
+	// Look for the end of the decel to go into HOLD state - the move that ends at zero.
+	// (Moves before it in a long decel end with velocity to spare.)
+	// mp_stop_callback() sets HOLD once the steppers have run it out.
+	if ((cm.hold_state == FEEDHOLD_DECEL) && (status != STAT_EAGAIN) && (fp_ZERO(mr.exit_velocity))) {
+		mb.hold_pending = true;
 	}
 
 
@@ -1046,8 +1876,11 @@ static stat_t _exec_aline(mpBuf_t *bf)
 	//	  STAT_OK		 MOVE_STATE_RUN	 mr and bf buffers are done
 	//	  STAT_OK		 MOVE_STATE_NEW	 mr done; bf must be run again (it's been reused)
 
-	if (status == STAT_EAGAIN) { 
+	if (status == STAT_EAGAIN) {
 		rpt_request_status_report(SR_TIMED_REQUEST); // continue reporting mr buffer
+		if (_get_preload_buffer() != NULL) {
+			st_request_exec_preload();			// load the next block in a spare exec
+		}
 	} else {
 		mr.move_state = MOVE_STATE_OFF;			// reset mr buffer
 		mr.section_state = MOVE_STATE_OFF;
@@ -1059,39 +1892,426 @@ static stat_t _exec_aline(mpBuf_t *bf)
 	return (status);
 }
 
+/*
+ * _load_aline() - load a runtime from a bf buffer, starting at the runtime's position
+ */
+static void _load_aline(mpMoveRuntimeSingleton_t *m, const mpBuf_t *bf)
+{
+	m->move_state = MOVE_STATE_HEAD;
+	m->section_state = MOVE_STATE_NEW;
+	m->linenum = bf->linenum;
+	m->motion_mode = bf->motion_mode;
+	m->jerk = bf->jerk;
+	m->head_length = bf->head_length;
+	m->body_length = bf->body_length;
+	m->tail_length = bf->tail_length;
+	m->entry_velocity = bf->entry_velocity;
+	m->cruise_velocity = bf->cruise_velocity;
+	m->exit_velocity = bf->exit_velocity;
+	m->move_type = bf->move_type;
+	copy_axis_vector(m->endpoint, bf->target);	// save the final target of the move
+	if (bf->move_type == MOVE_TYPE_ARC) {
+		_load_arc(m, bf);
+	} else {
+		set_unit_vector(m->unit, m->endpoint, m->position, get_axis_vector_length(m->endpoint, m->position));
+	}
+	m->axes = bf->axes;
+	for (uint8_t i=0; i<AXES; i++) {			// also run any axis that is off its endpoint
+		if (m->position[i] != m->endpoint[i]) { m->axes |= (1<<i);}
+	}
+}
+
+/*
+ * mp_preload_move() 	- load the next block into the shadow runtime (ms)
+ * _get_preload_buffer() - return the block to preload, or NULL if it's not time to
+ * _swap_in_preload()	 - start a block from ms if it was preloaded
+ *
+ *	Starting a block used to cost the most of any exec: loading mr from the bf
+ *	(a square root and a division per axis for the unit vector), setting up the
+ *	first section (more divisions and the segment count) and then running its
+ *	first segment, all in the one LO interrupt. The shadow runtime moves the
+ *	first two out of the boundary:
+ *
+ *	  - Once the running block is in the last half of its last section and
+ *		within PRELOAD_SEGMENTS of its end, _exec_aline() asks the stepper for
+ *		a spare exec (st_request_exec_preload()). That exec runs when the prep
+ *		ring is full, so it does not prep a segment and calls mp_preload_move().
+ *
+ *	  - Only a block the planner has already found optimally planned is 
+ *		preloaded (replannable is false), so taking it early changes no plan. 
+ *		The first call notes the block. The second call, at least one segment 
+ *		later, loads it into ms starting at mr.endpoint and sets up its first 
+ *		section. The gap is the same one Note 2 relies on: a planning pass the 
+ *		exec interrupted has finished writing the bf before ms reads it.
+ *
+ *	  - At the boundary _exec_aline() copies ms into mr and runs the first
+ *		segment straight away. mr is a singleton that the rest of the planner
+ *		reads by value, so the swap is a copy of the block fields, not a pointer.
+ *
+ *	The block is loaded the old way if it wasn't preloaded (the ring never
+ *	filled, or the block was too short) or mr did not end exactly on its
+ *	endpoint. Feedholds and overrides replan the blocks that follow mr, so no
+ *	preload is done while one is in progress and their callbacks drop ms.
+ */
+stat_t mp_preload_move()
+{
+	mpBuf_t *bf;
+
+	if ((bf = _get_preload_buffer()) == NULL) { return (STAT_NOOP);}
+	if (mr.preload_state == PRELOAD_OFF) {
+		mr.preload_bf = bf;
+		mr.preload_state = PRELOAD_PENDING;		// load it on the next spare exec
+		return (STAT_EAGAIN);
+	}
+	copy_axis_vector(ms.position, mr.endpoint);	// mr ends where the block starts
+	_load_aline(&ms, bf);
+	if (fp_ZERO(ms.head_length)) { ms.move_state = MOVE_STATE_BODY;}
+	if ((ms.move_state == MOVE_STATE_BODY) && (fp_ZERO(ms.body_length))) { ms.move_state = MOVE_STATE_TAIL;}
+	switch (ms.move_state) {
+		case (MOVE_STATE_HEAD): { if (_init_aline_head(&ms) != STAT_OK) return (STAT_NOOP); break;}
+		case (MOVE_STATE_BODY): { if (_init_aline_body(&ms) != STAT_OK) return (STAT_NOOP); break;}
+		default: { if (_init_aline_tail(&ms) != STAT_OK) return (STAT_NOOP);}
+	}
+	mr.preload_state = PRELOAD_READY;			// (a section too short to run is left to the boundary)
+	return (STAT_OK);
+}
+
+static mpBuf_t *_get_preload_buffer()
+{
+	mpBuf_t *bf = mb.r->nx;
+
+	if ((mr.preload_state == PRELOAD_READY) ||
+		(cm.hold_state != FEEDHOLD_OFF) || (mr.feed_override_state != FEED_OVERRIDE_OFF)) {
+		return (NULL);
+	}
+	switch (mr.move_state) {					// last half of the last section?
+		case (MOVE_STATE_HEAD): {
+			if ((mr.section_state != MOVE_STATE_RUN2) ||
+				(fp_NOT_ZERO(mr.body_length)) || (fp_NOT_ZERO(mr.tail_length))) { return (NULL);}
+			break;
+		}
+		case (MOVE_STATE_BODY): {
+			if ((mr.section_state != MOVE_STATE_RUN) || (fp_NOT_ZERO(mr.tail_length))) { return (NULL);}
+			break;
+		}
+		case (MOVE_STATE_TAIL): {
+			if (mr.section_state != MOVE_STATE_RUN2) { return (NULL);}
+			break;
+		}
+		default: { return (NULL);}
+	}
+	if ((mr.segment_count > PRELOAD_SEGMENTS) || (mb.r->buffer_state != MP_BUFFER_RUNNING) ||
+		(mp_is_aline(bf) == false) || (bf->move_state != MOVE_STATE_NEW) || (fp_ZERO(bf->length)) ||
+		(bf->replannable == true) ||
+		((bf->buffer_state != MP_BUFFER_QUEUED) && (bf->buffer_state != MP_BUFFER_PENDING))) {
+		return (NULL);
+	}
+	if ((mr.preload_state == PRELOAD_PENDING) && (mr.preload_bf != bf)) { return (NULL);}
+	return (bf);
+}
+
+static uint8_t _swap_in_preload(const mpBuf_t *bf)
+{
+	uint8_t preload_state = mr.preload_state;
+
+	mr.preload_state = PRELOAD_OFF;
+	if ((preload_state != PRELOAD_READY) || (mr.preload_bf != bf)) { return (false);}
+	for (uint8_t i=0; i<AXES; i++) {
+		if (mr.position[i] != ms.position[i]) { return (false);}
+	}
+	MP_STAT(mps.preloads++);
+	mr.move_state = ms.move_state;
+	mr.section_state = ms.section_state;
+	mr.linenum = ms.linenum;
+	mr.motion_mode = ms.motion_mode;
+	mr.move_type = ms.move_type;
+	mr.axes = ms.axes;
+	if (ms.move_type == MOVE_TYPE_ARC) {
+		mr.axis_1 = ms.axis_1;
+		mr.axis_2 = ms.axis_2;
+		mr.correction_count = ms.correction_count;
+		mr.center_1 = ms.center_1;
+		mr.center_2 = ms.center_2;
+		mr.radius = ms.radius;
+		mr.angular_rate = ms.angular_rate;
+		mr.theta = ms.theta;
+		mr.endpoint_theta = ms.endpoint_theta;
+		mr.section_end_theta = ms.section_end_theta;
+		mr.offset_1 = ms.offset_1;
+		mr.offset_2 = ms.offset_2;
+	}
+	copy_axis_vector(mr.endpoint, ms.endpoint);
+	copy_axis_vector(mr.unit, ms.unit);
+	mr.jerk = ms.jerk;
+	mr.head_length = ms.head_length;
+	mr.body_length = ms.body_length;
+	mr.tail_length = ms.tail_length;
+	mr.entry_velocity = ms.entry_velocity;
+	mr.cruise_velocity = ms.cruise_velocity;
+	mr.exit_velocity = ms.exit_velocity;
+	mr.move_time = ms.move_time;
+	mr.midpoint_velocity = ms.midpoint_velocity;
+	mr.segments = ms.segments;
+	mr.segment_count = ms.segment_count;
+	mr.segment_move_time = ms.segment_move_time;
+	mr.microseconds = ms.microseconds;
+	mr.section_remaining = ms.section_remaining;
+	copy_axis_vector(mr.section_end, ms.section_end);
+	mr.forward_diff_1 = ms.forward_diff_1;
+	mr.forward_diff_2 = ms.forward_diff_2;
+	mr.forward_diff_3 = ms.forward_diff_3;
+	return (true);
+}
+
 /* Forward difference math explained:
- * 	We're using two quadratic curves end-to-end, forming the concave and convex 
- *	section of the s-curve. For each half, we have three points:
- *
- *    T[0] is the start point, or the entro or middle of the "s". This will be one of:
- *  	- entry_velocity (acceleration concave),
- * 		- cruise_velocity (deceleration concave), or
- * 		- midpoint_velocity (convex)
- *	  T[1] is the "control point" set to T[0] for concave sections, and T[2] for convex
- *	  T[2] is the end point of the quadratic, which will be the midpoint or endpoint of the s.
- *
- *  TODO MATH EXPLANATION
- *  
- *    A = T[0] - 2*T[1] + T[2]
- *    B = 2 * (T[1] - T[0])
- *    C = T[0]
- *    h = (1/mr.segments)
- *
- *  forward_diff_1 = Ah^2+Bh = (T[0] - 2*T[1] + T[2])h*h + (2 * (T[1] - T[0]))h
- *  forward_diff_2 = 2Ah^2 = 2*(T[0] - 2*T[1] + T[2])h*h
+ * 	We're using two quadratic velocity curves end-to-end, forming the concave
+ *	and convex halves of the s-curve. Each half runs for time T with u = t/T going
+ *	from 0 to 1. Vs is the velocity the s starts at (entry_velocity for a head,
+ *	cruise_velocity for a tail) and Vm the midpoint_velocity:
+ *
+ *	  first half:	V(u) = Vs + (Vm-Vs)u²
+ *	  second half:	V(u) = Vm + 2(Vm-Vs)u - (Vm-Vs)u²
+ *
+ *	Constant jerk makes the distance run since the start of the half a cubic:
+ *
+ *	  P(u) = Au³ + Bu² + Cu
+ *	  first half:	A =  T(Vm-Vs)/3,	B = 0,			C = T*Vs
+ *	  second half:	A = -T(Vm-Vs)/3,	B = T(Vm-Vs),	C = T*Vm
+ *
+ *	Stepping u by h = 1/segments the forward differences of P are
+ *
+ *	  forward_diff_1 = Ah³ + Bh² + Ch	(the length of the next segment)
+ *	  forward_diff_2 = 6Ah³ + 2Bh²
+ *	  forward_diff_3 = 6Ah³				(constant)
+ *
+ *	So each segment is its exact share of the s-curve rather than velocity * time,
+ *	and costs two adds. Th is the segment_move_time. A body is the degenerate case
+ *	A = B = 0 and forward_diff_1 = cruise_velocity * segment_move_time.
+ */
+static void _init_forward_diffs(mpMoveRuntimeSingleton_t *m, float vs, uint8_t second_half)
+{
+	float h = 1/m->segments;
+	float dvTh = (m->midpoint_velocity - vs) * m->segment_move_time;	// T(Vm-Vs)h
+	float Ah_cubed = dvTh * h*h / 3;
+
+	if (second_half == false) {
+		m->forward_diff_1 = Ah_cubed + (vs * m->segment_move_time);
+		m->forward_diff_2 = 6*Ah_cubed;
+	} else {
+		Ah_cubed = -Ah_cubed;
+		m->forward_diff_1 = Ah_cubed + (dvTh * h) + (m->midpoint_velocity * m->segment_move_time);
+		m->forward_diff_2 = 6*Ah_cubed + 2*dvTh*h;
+	}
+	m->forward_diff_3 = 6*Ah_cubed;
+}
+
+/*
+ * _init_section_end() - set where a section ends and how far it runs
+ *
+ *	Segments target section_end less the distance still to run, so the last one
+ *	lands on it exactly. The last section of a block ends on the block's endpoint.
+ */
+static void _init_section_end(mpMoveRuntimeSingleton_t *m, const float length, const uint8_t last)
+{
+	m->section_remaining = length;
+	if (last == true) {
+		copy_axis_vector(m->section_end, m->endpoint);
+		m->section_end_theta = m->endpoint_theta;
+	} else {
+		m->section_end_theta = _get_runtime_point(m, length, m->section_end);
+	}
+}
+
+/*
+ * _get_runtime_point() - set point to where a runtime will be once it has run length further
+ * _get_runtime_length() - length a runtime has left to run to its endpoint
+ *
+ *	The first returns the arc angle at the point (nothing useful for a line).
  */
+static float _get_runtime_point(const mpMoveRuntimeSingleton_t *m, const float length, float point[])
+{
+	for (uint8_t i=0; i<AXES; i++) {
+		point[i] = m->position[i] + (m->unit[i] * length);
+	}
+	if (m->move_type != MOVE_TYPE_ARC) { return (0);}
+	float theta = m->theta + (m->angular_rate * length);
+	point[m->axis_1] = m->center_1 + (sin(theta) * m->radius);
+	point[m->axis_2] = m->center_2 + (cos(theta) * m->radius);
+	return (theta);
+}
+
+static float _get_runtime_length(const mpMoveRuntimeSingleton_t *m)
+{
+	if (m->move_type == MOVE_TYPE_ARC) {
+		return ((m->endpoint_theta - m->theta) / m->angular_rate);
+	}
+	return (get_axis_vector_length(m->endpoint, m->position));
+}
 
-// NOTE: t1 will always be == t0, so we don't pass it
-static void _init_forward_diffs(float t0, float t2)
+/*
+ * _load_arc() 		  - load the arc of a bf buffer into a runtime
+ * _set_arc_offsets() - place the runtime's last target exactly at its angle
+ * _set_arc_target()  - put the plane axes of the next segment's target on the arc
+ *
+ *	An arc block runs through the aline runtime like a line of its length. The 
+ *	axes off the plane (a helix) run along unit as for a line; unit is zero on the
+ *	plane axes and _exec_aline_segment() has _set_arc_target() place them.
+ *
+ *	A segment ends at the angle section_remaining short of the section end, which
+ *	is where the point has to be however the segments were cut. The point is the 
+ *	last one rotated about the center by the change in angle. Segments are short
+ *	(see _get_arc_vmax()), so the sine and cosine - 1 of the change are taken from
+ *	the first terms of their series, which costs a few multiplies where sin() and
+ *	cos() are the most expensive calls in the LO interrupt. As in the old arc 
+ *	generator every ARC_CORRECTION_SEGMENTS'th point is placed exactly to bound
+ *	the rounding drift, and so is a rotation of more than ARC_ROTATION_MAX. Each
+ *	section ends exactly on its section end. tinyg_bench checks every segment 
+ *	against the exact helix (make arcs).
+ */
+static void _load_arc(mpMoveRuntimeSingleton_t *m, const mpBuf_t *bf)
 {
-	float H_squared = square(1/mr.segments);
-	// A = T[0] - 2*T[1] + T[2], if T[0] == T[1], then it becomes - T[0] + T[2]
-	float AH_squared = (t2 - t0) * H_squared;
-	
-	// Ah²+Bh, and B=2 * (T[1] - T[0]), if T[0] == T[1], then it becomes simply Ah^2
-	mr.forward_diff_1 = AH_squared;
-	mr.forward_diff_2 = 2*AH_squared;
-	mr.segment_velocity = t0;
+	m->axis_1 = bf->axis_1;
+	m->axis_2 = bf->axis_2;
+	_get_arc_center(bf, &m->center_1, &m->center_2);
+	m->radius = bf->radius;
+	m->angular_rate = bf->angular_rate;
+	m->endpoint_theta = bf->theta;
+	m->theta = bf->theta - (bf->angular_rate * bf->length);
+	_set_arc_offsets(m);
+	for (uint8_t i=0; i<AXES; i++) {
+		m->unit[i] = (m->endpoint[i] - m->position[i]) / bf->length;
+	}
+	m->unit[m->axis_1] = 0;
+	m->unit[m->axis_2] = 0;
+}
+
+/*
+ * _get_arc_center() - the center of an arc block, from the point it ends on
+ *
+ *	A block doesn't keep its center. The target is on the arc at theta (see 
+ *	mp_arc()), so the center is the target less the radius at that angle. This
+ *	costs a sine and a cosine per arc block, and 8 bytes less in every buffer.
+ */
+static void _get_arc_center(const mpBuf_t *bf, float *center_1, float *center_2)
+{
+	*center_1 = bf->target[bf->axis_1] - (sin(bf->theta) * bf->radius);
+	*center_2 = bf->target[bf->axis_2] - (cos(bf->theta) * bf->radius);
+}
+
+static void _set_arc_offsets(mpMoveRuntimeSingleton_t *m)
+{
+	m->offset_1 = sin(m->theta) * m->radius;
+	m->offset_2 = cos(m->theta) * m->radius;
+	m->correction_count = ARC_CORRECTION_SEGMENTS;
+}
+
+static void _set_arc_target()
+{
+	float theta = mr.section_end_theta - (mr.angular_rate * mr.section_remaining);
+	float delta = theta - mr.theta;
+
+	mr.theta = theta;
+	if (fp_ZERO(mr.section_remaining)) {		// the section end (set by _exec_aline_segment())
+		mr.offset_1 = mr.target[mr.axis_1] - mr.center_1;
+		mr.offset_2 = mr.target[mr.axis_2] - mr.center_2;
+		return;
+	}
+	if ((--mr.correction_count == 0) || (fabs(delta) > ARC_ROTATION_MAX)) {
+		_set_arc_offsets(&mr);
+	} else {
+		float delta_squared = square(delta);
+		float sine = delta * (1 - delta_squared / 6 * (1 - delta_squared / 20));
+		float cosm1 = -delta_squared / 2 * (1 - delta_squared / 12 * (1 - delta_squared / 30));
+		float offset_1 = mr.offset_1;
+		mr.offset_1 += (offset_1 * cosm1) + (mr.offset_2 * sine);
+		mr.offset_2 += (mr.offset_2 * cosm1) - (offset_1 * sine);
+	}
+	mr.target[mr.axis_1] = mr.center_1 + mr.offset_1;
+	mr.target[mr.axis_2] = mr.center_2 + mr.offset_2;
+}
+
+/*
+ * _get_ramp_segment_usec() - segment time for a head or tail
+ * _get_segments() 			- number of segments to divide a section (or half of one) into
+ *
+ *	Segments run at constant velocity, so a head or tail is a staircase of velocity
+ *	steps. The steepest step is at the middle of the ramp, where the acceleration
+ *	peaks at 2*dV/T. Ramps are cut into segments short enough to keep that step 
+ *	within SEGMENT_VELOCITY_STEP, down to MIN_SEGMENT_USEC, and no longer than 
+ *	the nominal segment time ($ms). Bodies have no steps and use the longer 
+ *	$mx segment time to cut LO interrupt load.
+ *
+ *	The segment count never makes a segment shorter than MIN_SEGMENT_USEC unless 
+ *	the section itself is. A section that short is skipped as before.
+ */
+static float _get_ramp_segment_usec(const float move_time, const float velocity_change)
+{
+	if (velocity_change < EPSILON) { return (cfg.estd_segment_usec);}
+	float usec = uSec(SEGMENT_VELOCITY_STEP * move_time / (2 * velocity_change));
+	return (max(MIN_SEGMENT_USEC, min(usec, cfg.estd_segment_usec)));
+}
+
+static float _get_segments(const float section_usec, const float segment_usec)
+{
+	return (max(1, min(ceil(section_usec / segment_usec), floor(section_usec / MIN_SEGMENT_USEC))));
+}
+
+/*
+ * _init_aline_head() - set up a head section in a runtime (mr or the shadow ms)
+ * _init_aline_body() - set up a body section
+ * _init_aline_tail() - set up a tail section
+ *
+ *	Return STAT_GCODE_BLOCK_SKIPPED if the segments would be too short to run.
+ */
+static stat_t _init_aline_head(mpMoveRuntimeSingleton_t *m)
+{
+	m->midpoint_velocity = (m->entry_velocity + m->cruise_velocity) / 2;
+	m->move_time = m->head_length / m->midpoint_velocity;	// time for entire accel region
+	m->segments = _get_segments(uSec(m->move_time) / 2,		// # of segments in *each half*
+								_get_ramp_segment_usec(m->move_time, m->cruise_velocity - m->entry_velocity));
+	m->segment_move_time = m->move_time / (2 * m->segments);
+	m->segment_count = (uint32_t)m->segments;
+	if ((m->microseconds = uSec(m->segment_move_time)) < MIN_SEGMENT_USEC) {
+		return(STAT_GCODE_BLOCK_SKIPPED);
+	}
+	_init_forward_diffs(m, m->entry_velocity, false);
+	_init_section_end(m, m->head_length, (fp_ZERO(m->body_length) && fp_ZERO(m->tail_length)));
+	m->section_state = MOVE_STATE_RUN1;
+	return (STAT_OK);
+}
+
+static stat_t _init_aline_body(mpMoveRuntimeSingleton_t *m)
+{
+	m->move_time = m->body_length / m->cruise_velocity;
+	m->segments = _get_segments(uSec(m->move_time), cfg.max_segment_usec);
+	m->segment_move_time = m->move_time / m->segments;
+	m->segment_count = (uint32_t)m->segments;
+	if ((m->microseconds = uSec(m->segment_move_time)) < MIN_SEGMENT_USEC) {
+		return(STAT_GCODE_BLOCK_SKIPPED);
+	}
+	m->forward_diff_1 = m->cruise_velocity * m->segment_move_time;
+	m->forward_diff_2 = 0;
+	m->forward_diff_3 = 0;
+	_init_section_end(m, m->body_length, fp_ZERO(m->tail_length));
+	m->section_state = MOVE_STATE_RUN;
+	return (STAT_OK);
+}
+
+static stat_t _init_aline_tail(mpMoveRuntimeSingleton_t *m)
+{
+	m->midpoint_velocity = (m->cruise_velocity + m->exit_velocity) / 2;
+	m->move_time = m->tail_length / m->midpoint_velocity;
+	m->segments = _get_segments(uSec(m->move_time) / 2,		// # of segments in *each half*
+								_get_ramp_segment_usec(m->move_time, m->cruise_velocity - m->exit_velocity));
+	m->segment_move_time = m->move_time / (2 * m->segments);// time to advance for each segment
+	m->segment_count = (uint32_t)m->segments;
+	if ((m->microseconds = uSec(m->segment_move_time)) < MIN_SEGMENT_USEC) {
+		return(STAT_GCODE_BLOCK_SKIPPED);
+	}
+	_init_forward_diffs(m, m->cruise_velocity, false);
+	_init_section_end(m, m->tail_length, true);
+	m->section_state = MOVE_STATE_RUN1;
+	return (STAT_OK);
 }
 
 /*
@@ -1104,35 +2324,20 @@ static stat_t _exec_aline_head()
 			mr.move_state = MOVE_STATE_BODY;
 			return(_exec_aline_body());			// skip ahead to the body generator
 		}
-		mr.midpoint_velocity = (mr.entry_velocity + mr.cruise_velocity) / 2;
-		mr.move_time = mr.head_length / mr.midpoint_velocity;	// time for entire accel region
-		mr.segments = ceil(uSec(mr.move_time) / (2 * cfg.estd_segment_usec)); // # of segments in *each half*
-		mr.segment_move_time = mr.move_time / (2 * mr.segments);
-		mr.segment_count = (uint32_t)mr.segments;
-		if ((mr.microseconds = uSec(mr.segment_move_time)) < MIN_SEGMENT_USEC) {
-			return(STAT_GCODE_BLOCK_SKIPPED);		// exit without advancing position
+		if (_init_aline_head(&mr) != STAT_OK) {
+			return(STAT_GCODE_BLOCK_SKIPPED);	// exit without advancing position
 		}
-		_init_forward_diffs(mr.entry_velocity, mr.midpoint_velocity);
-		mr.section_state = MOVE_STATE_RUN1;
 	}
 	if (mr.section_state == MOVE_STATE_RUN1) {	// concave part of accel curve (period 1)
-		mr.segment_velocity += mr.forward_diff_1;
 		if (_exec_aline_segment(false) == STAT_COMPLETE) { // set up for second half
 			mr.segment_count = (uint32_t)mr.segments;
 			mr.section_state = MOVE_STATE_RUN2;
-
-			// Here's a trick: The second half of the S starts at the end of the first,
-			//  And the only thing that changes is the sign of mr.forward_diff_2
-			mr.forward_diff_2 = -mr.forward_diff_2;
-		} else {
-			mr.forward_diff_1 += mr.forward_diff_2;
+			_init_forward_diffs(&mr, mr.entry_velocity, true);
 		}
 		return(STAT_EAGAIN);
 	}
 	if (mr.section_state == MOVE_STATE_RUN2) {	// convex part of accel curve (period 2)
-		mr.segment_velocity += mr.forward_diff_1;
-		mr.forward_diff_1 += mr.forward_diff_2;
-		if (_exec_aline_segment(false) == STAT_COMPLETE) {
+		if (_exec_aline_segment(true) == STAT_COMPLETE) {
 			if ((fp_ZERO(mr.body_length)) && (fp_ZERO(mr.tail_length))) { return(STAT_OK);}	// end the move
 			mr.move_state = MOVE_STATE_BODY;
 			mr.section_state = MOVE_STATE_NEW;
@@ -1154,19 +2359,12 @@ static stat_t _exec_aline_body()
 			mr.move_state = MOVE_STATE_TAIL;
 			return(_exec_aline_tail());			// skip ahead to tail periods
 		}
-		mr.move_time = mr.body_length / mr.cruise_velocity;
-		mr.segments = ceil(uSec(mr.move_time) / cfg.estd_segment_usec);
-		mr.segment_move_time = mr.move_time / mr.segments;
-		mr.segment_velocity = mr.cruise_velocity;
-		mr.segment_count = (uint32_t)mr.segments;
-		if ((mr.microseconds = uSec(mr.segment_move_time)) < MIN_SEGMENT_USEC) {
-			return(STAT_GCODE_BLOCK_SKIPPED);		// exit without advancing position
+		if (_init_aline_body(&mr) != STAT_OK) {
+			return(STAT_GCODE_BLOCK_SKIPPED);	// exit without advancing position
 		}
-		
-		mr.section_state = MOVE_STATE_RUN;
 	}
 	if (mr.section_state == MOVE_STATE_RUN) {				// stright part (period 3)
-		if (_exec_aline_segment(false) == STAT_COMPLETE) {
+		if (_exec_aline_segment(true) == STAT_COMPLETE) {
 			if (fp_ZERO(mr.tail_length)) { return(STAT_OK);}	// end the move
 			mr.move_state = MOVE_STATE_TAIL;
 			mr.section_state = MOVE_STATE_NEW;
@@ -1182,34 +2380,19 @@ static stat_t _exec_aline_tail()
 {
 	if (mr.section_state == MOVE_STATE_NEW) {
 		if (fp_ZERO(mr.tail_length)) { return(STAT_OK);}		// end the move
-		mr.midpoint_velocity = (mr.cruise_velocity + mr.exit_velocity) / 2;
-		mr.move_time = mr.tail_length / mr.midpoint_velocity;
-		mr.segments = ceil(uSec(mr.move_time) / (2 * cfg.estd_segment_usec));// # of segments in *each half*
-		mr.segment_move_time = mr.move_time / (2 * mr.segments);// time to advance for each segment
-		mr.segment_count = (uint32_t)mr.segments;
-		if ((mr.microseconds = uSec(mr.segment_move_time)) < MIN_SEGMENT_USEC) {
+		if (_init_aline_tail(&mr) != STAT_OK) {
 			return(STAT_GCODE_BLOCK_SKIPPED);					// exit without advancing position
 		}
-		_init_forward_diffs(mr.cruise_velocity, mr.midpoint_velocity);
-		mr.section_state = MOVE_STATE_RUN1;
 	}
 	if (mr.section_state == MOVE_STATE_RUN1) {				// convex part (period 4)
-		mr.segment_velocity += mr.forward_diff_1;
 		if (_exec_aline_segment(false) == STAT_COMPLETE) { 	  	// set up for second half
 			mr.segment_count = (uint32_t)mr.segments;
 			mr.section_state = MOVE_STATE_RUN2;
-
-			// Here's a trick: The second half of the S starts at the end of the first,
-			//  And the only thing that changes is the sign of mr.forward_diff_2
-			mr.forward_diff_2 = -mr.forward_diff_2;
-		} else {
-			mr.forward_diff_1 += mr.forward_diff_2;
+			_init_forward_diffs(&mr, mr.cruise_velocity, true);
 		}
 		return(STAT_EAGAIN);
 	}
 	if (mr.section_state == MOVE_STATE_RUN2) {				// concave part (period 5)
-		mr.segment_velocity += mr.forward_diff_1;
-		mr.forward_diff_1 += mr.forward_diff_2;
 		if (_exec_aline_segment(true) == STAT_COMPLETE) { return (STAT_OK);}	// end the move
 	}
 	return(STAT_EAGAIN);
@@ -1217,62 +2400,54 @@ static stat_t _exec_aline_tail()
 
 /*
  * _exec_aline_segment() - segment runner helper
+ *
+ *	last_half is true for the half (or body) that ends the section. Its last 
+ *	segment runs out what is left of the section, so the section ends exactly on
+ *	section_end - feedhold tails included - and rounding never carries over.
+ *
+ *	Only the axes in mr.axes are computed. The others keep their position and 
+ *	have no travel. The plane axes of an arc are then put on the arc.
  */
-static stat_t _exec_aline_segment(uint8_t correction_flag)
+static stat_t _exec_aline_segment(uint8_t last_half)
 {
 	float travel[AXES];
 	float steps[MOTORS];
-
-	// Multiply computed length by the unit vector to get the contribution for
-	// each axis. Set the target in absolute coords and compute relative steps.
-
-	if ((correction_flag == true) && (mr.segment_count == 1) && 
-		(cm.motion_state == MOTION_RUN) && (cm.cycle_state == CYCLE_MACHINING)) {
-		mr.target[AXIS_X] = mr.endpoint[AXIS_X];	// rounding error correction for last segment
-		mr.target[AXIS_Y] = mr.endpoint[AXIS_Y];
-		mr.target[AXIS_Z] = mr.endpoint[AXIS_Z];
-		mr.target[AXIS_A] = mr.endpoint[AXIS_A];
-		mr.target[AXIS_B] = mr.endpoint[AXIS_B];
-		mr.target[AXIS_C] = mr.endpoint[AXIS_C];
+	uint8_t motors;
+
+	MP_STAT(mps.segments++);
+	mr.segment_length = mr.forward_diff_1;
+	mr.segment_velocity = mr.segment_length / mr.segment_move_time;
+	if ((last_half == true) && (mr.segment_count == 1)) {
+		mr.section_remaining = 0;
+	} else if (mr.move_state == MOVE_STATE_BODY) {	// long bodies would pile up rounding
+		mr.section_remaining = mr.segment_length * (mr.segment_count - 1);
 	} else {
-		float intermediate = mr.segment_velocity * mr.segment_move_time;
-		mr.target[AXIS_X] = mr.position[AXIS_X] + (mr.unit[AXIS_X] * intermediate);
-		mr.target[AXIS_Y] = mr.position[AXIS_Y] + (mr.unit[AXIS_Y] * intermediate);
-		mr.target[AXIS_Z] = mr.position[AXIS_Z] + (mr.unit[AXIS_Z] * intermediate);
-		mr.target[AXIS_A] = mr.position[AXIS_A] + (mr.unit[AXIS_A] * intermediate);
-		mr.target[AXIS_B] = mr.position[AXIS_B] + (mr.unit[AXIS_B] * intermediate);
-		mr.target[AXIS_C] = mr.position[AXIS_C] + (mr.unit[AXIS_C] * intermediate);
-	}
-	travel[AXIS_X] = mr.target[AXIS_X] - mr.position[AXIS_X];
-	travel[AXIS_Y] = mr.target[AXIS_Y] - mr.position[AXIS_Y];
-	travel[AXIS_Z] = mr.target[AXIS_Z] - mr.position[AXIS_Z];
-	travel[AXIS_A] = mr.target[AXIS_A] - mr.position[AXIS_A];
-	travel[AXIS_B] = mr.target[AXIS_B] - mr.position[AXIS_B];
-	travel[AXIS_C] = mr.target[AXIS_C] - mr.position[AXIS_C];
-
-/* The above is a re-arranged and loop unrolled version of this:
-	for (uint8_t i=0; i < AXES; i++) {	// don't do the error correction if you are going into a hold
-		if ((correction_flag == true) && (mr.segment_count == 1) && 
-			(cm.motion_state == MOTION_RUN) && (cm.cycle_state == CYCLE_STARTED)) {
-			mr.target[i] = mr.endpoint[i];	// rounding error correction for last segment
-		} else {
-			mr.target[i] = mr.position[i] + (mr.unit[i] * mr.segment_velocity * mr.segment_move_time);
+		mr.section_remaining -= mr.segment_length;
+	}
+	mr.forward_diff_1 += mr.forward_diff_2;
+	mr.forward_diff_2 += mr.forward_diff_3;
+
+	// Back the distance still to run off the section end along the unit vector to
+	// get the target in absolute coords, then compute relative steps.
+	for (uint8_t i=0; i < AXES; i++) {
+		if ((mr.axes & (1<<i)) == 0) {
+			mr.target[i] = mr.position[i];
+			travel[i] = 0;
+			continue;
 		}
+		mr.target[i] = mr.section_end[i] - (mr.unit[i] * mr.section_remaining);
 		travel[i] = mr.target[i] - mr.position[i];
 	}
-*/
+	if (mr.move_type == MOVE_TYPE_ARC) {
+		_set_arc_target();
+		travel[mr.axis_1] = mr.target[mr.axis_1] - mr.position[mr.axis_1];
+		travel[mr.axis_2] = mr.target[mr.axis_2] - mr.position[mr.axis_2];
+	}
+
 	// prep the segment for the steppers and adjust the variables for the next iteration
-	ik_kinematics(travel, steps, mr.microseconds);
-	if (st_prep_line(steps, mr.microseconds) == STAT_OK) {
+	motors = ik_kinematics(mr.axes, travel, steps, mr.microseconds);
+	if (st_prep_line(steps, motors, mr.microseconds) == STAT_OK) {
 		copy_axis_vector(mr.position, mr.target); 	// update runtime position	
-/*  TRY THIS
-		mr.position[AXIS_X] = mr.target[AXIS_X];
-		mr.position[AXIS_Y] = mr.target[AXIS_Y];
-		mr.position[AXIS_Z] = mr.target[AXIS_Z];
-		mr.position[AXIS_A] = mr.target[AXIS_A];
-		mr.position[AXIS_B] = mr.target[AXIS_B];
-		mr.position[AXIS_C] = mr.target[AXIS_C];	
-*/	
 	}
 	if (--mr.segment_count == 0) {
 		return (STAT_COMPLETE);	// this section has run all its segments
@@ -68,6 +68,7 @@
 #include "stepper.h"
 #include "report.h"
 #include "util.h"
+#include "xmega/xmega_rtc.h"
 //#include "xio/xio.h"			// uncomment for debugging
 
 /*
@@ -81,6 +82,9 @@
 // execution routines (NB: These are all called from the LO interrupt)
 static stat_t _exec_dwell(mpBuf_t *bf);
 static stat_t _exec_command(mpBuf_t *bf);
+static stat_t _exec_inline_command(mpBuf_t *bf);
+static uint8_t _startup_hold(void);
+static float _get_buffer_ms(const mpBuf_t *bf);
 
 #ifdef __DEBUG
 static uint8_t _get_buffer_index(mpBuf_t *bf); 
@@ -99,8 +103,8 @@ void mp_init()
 
 	mr.magic_start = MAGICNUM;
 	mr.magic_end = MAGICNUM;
-	ar.magic_start = MAGICNUM;
-	ar.magic_end = MAGICNUM;
+	mm.feed_override_factor = 1;
+	mm.traverse_override_factor = 1;
 	mp_init_buffers();
 }
 
@@ -114,9 +118,12 @@ void mp_init()
  */
 void mp_flush_planner()
 {
-	ar_abort_arc();
 	mp_init_buffers();
 	cm.motion_state = MOTION_STOP;
+	mr.feed_override_state = FEED_OVERRIDE_OFF;			// nothing left to replan
+	mr.preload_state = PRELOAD_OFF;						// ...or to preload
+	mm.hold_replan = NULL;								// ...or to replan behind a hold
+	copy_axis_vector(mm.work_offset, mr.work_offset);	// any queued offset change was flushed
 //	copy_axis_vector(mm.position, mr.position);
 }
 
@@ -172,11 +179,15 @@ stat_t mp_exec_move()
 {
 	mpBuf_t *bf;
 
+	if (_startup_hold() == true) {								// let the queue fill before starting
+		mb.start_held = true;									// mp_start_callback() releases it
+		return (STAT_NOOP);
+	}
 	if ((bf = mp_get_run_buffer()) == NULL) return (STAT_NOOP);	// NULL means nothing's running
 
 	// Manage cycle and motion state transitions. 
 	// Cycle auto-start for lines only. 
-	if (bf->move_type == MOVE_TYPE_ALINE) {
+	if (mp_is_aline(bf) == true) {
 		if (cm.cycle_state == CYCLE_OFF) cm_cycle_start();
 		if (cm.motion_state == MOTION_STOP) cm.motion_state = MOTION_RUN;
 	}
@@ -188,6 +199,76 @@ stat_t mp_exec_move()
 	return (STAT_INTERNAL_ERROR);		// never supposed to get here
 }
 
+/*
+ * _startup_hold() 		 - return TRUE if a start from standstill should wait for the queue
+ * mp_start_callback()	 - release a start that is waiting (main loop)
+ *
+ *	This replaces the PLANNER_STARTUP_DELAY_SECONDS dwell that used to be queued
+ *	ahead of the first move (and has long been commented out). A line is not 
+ *	started from a standstill until the queue holds PLANNER_STARTUP_MS of motion 
+ *	behind it (see mp_get_planner_lookahead_ms()), the queue is out of headroom, 
+ *	or the startup delay has passed since the first line was queued - whichever 
+ *	comes first. A fast sender starts at once with a full plan; a single MDI line 
+ *	waits at most the delay. Homing and the other special cycles start at once.
+ *
+ *	Each queued block requests an exec, so the first two are seen as the lines
+ *	arrive. Only the delay runs out with nothing else happening: an exec that 
+ *	holds a start sets mb.start_held, and the callback checks the clock from the
+ *	main loop and requests the exec once, when the hold releases. 
+ */
+static uint8_t _startup_hold()
+{
+	if (((cm.cycle_state != CYCLE_OFF) && (cm.cycle_state != CYCLE_MACHINING)) ||
+		(mr.move_state != MOVE_STATE_OFF) || (st_isbusy() == true) ||
+		(mp_is_aline(mb.r) == false) ||
+		((mb.r->buffer_state != MP_BUFFER_QUEUED) && (mb.r->buffer_state != MP_BUFFER_PENDING))) {
+		return (false);						// not starting a line from a standstill
+	}
+	if ((mp_get_planner_lookahead_ms() >= PLANNER_STARTUP_MS) || 
+		(mb.buffers_available < PLANNER_BUFFER_HEADROOM) ||
+		((rtc.clock_ticks - mb.start_ticks) >= (uint32_t)(PLANNER_STARTUP_DELAY_SECONDS * 1000 / RTC_MILLISECONDS))) {
+		return (false);
+	}
+	return (true);
+}
+
+stat_t mp_start_callback()
+{
+	if ((mb.start_held == false) || (_startup_hold() == true)) { return (STAT_NOOP);}
+	mb.start_held = false;
+	st_request_exec_move();
+	return (STAT_OK);
+}
+
+/*
+ * mp_stop_callback() - enter a feedhold or end the cycle once the steppers stop (main loop)
+ *
+ *	Exec runs up to STEP_PREP_RING_SIZE segments ahead of the steppers, so the 
+ *	end of a hold's decel and the last block leaving the queue are seen while 
+ *	the machine is still moving. _exec_aline() and mp_free_run_buffer() only 
+ *	mark them, and the HOLD state and the cycle end are set here when the prep
+ *	ring has drained and the DDA has stopped. A queue flush or cycle start is 
+ *	not honored until then (see cm_feedhold_sequencing_callback()).
+ */
+stat_t mp_stop_callback()
+{
+	if (((mb.hold_pending == false) && (mb.end_pending == false)) ||
+		(st_prep_isbusy() == true) || (st_isbusy() == true)) {
+		return (STAT_NOOP);
+	}
+	if (mb.hold_pending == true) {
+		mb.hold_pending = false;
+		cm.hold_state = FEEDHOLD_HOLD;
+		cm.motion_state = MOTION_HOLD;
+		rpt_request_status_report(SR_IMMEDIATE_REQUEST);
+	}
+	if (mb.end_pending == true) {
+		mb.end_pending = false;
+		cm_cycle_end();
+	}
+	return (STAT_OK);
+}
+
 /************************************************************************************
  * mp_queue_command() - queue a synchronous Mcode, program control, or other command
  *
@@ -199,6 +280,8 @@ stat_t mp_exec_move()
  *	  - the planning queue gets to the function and calls _exec_command()
  *	  - ...which passes the saved parameters to the callback function
  *	  - To finish up _exec_command() needs to run a null pre and free the planner buffer
+ *	  - The command waits for the segments ahead of it in the stepper prep ring
+ *		to load, so it still runs as the last segment before it starts
  *
  *	Doing it this way instead of synchronizing on queue empty simplifies the
  *	handling of feedholds, feed overrides, buffer flushes, and thread blocking,
@@ -223,10 +306,60 @@ void mp_queue_command(void(*cm_exec)(uint8_t, float), uint8_t int_val, float flo
 
 static stat_t _exec_command(mpBuf_t *bf)
 {
+	if (st_prep_isbusy() == true) return (STAT_NOOP);	// the loader asks again as it drains
 	bf->cm_func(bf->int_val, bf->dbl_val);
 	st_prep_null();			// Must call a null prep to keep the loader happy. 
 	mp_free_run_buffer();
 	return (STAT_OK);
+}
+
+/*
+ * mp_queue_inline_command() - queue a synchronous command that does not stop motion
+ *
+ *	Same as mp_queue_command() but for commands that only need to happen at the 
+ *	right place in the program, not at a standstill: coolant, spindle speed (PWM),
+ *	tool select and the like. Plain commands plan to zero velocity on both sides,
+ *	so every inline S word or coolant toggle would stop the machine.
+ *
+ *	An inline command is a zero length block that the planner plans straight 
+ *	through. Its vmax's are unlimited so only its neighbors set the junction 
+ *	velocity, and its braking velocity starts at zero so the block before it 
+ *	still plans to a stop until the next line is queued (see _plan_block_list()).
+ *	The runtime reaches the block boundary up to STEP_PREP_RING_SIZE segments 
+ *	before the steppers do, so it does not fire the callback itself. It preps 
+ *	the command into the ring in place of a segment (st_prep_command()) and the
+ *	loader fires it once the last segment of the block before it has run. Each
+ *	command of a run takes its own exec pass, so the exec does not recurse.
+ */
+
+void mp_queue_inline_command(void(*cm_exec)(uint8_t, float), uint8_t int_val, float float_val)
+{
+	mpBuf_t *bf;
+
+	// this error is not reported as buffer availability was checked upstream in the controller
+	if ((bf = mp_get_write_buffer()) == NULL) return;
+
+	bf->move_type = MOVE_TYPE_INLINE_COMMAND;
+	bf->bf_func = _exec_inline_command;
+	bf->cm_func = cm_exec;
+	bf->int_val = int_val;
+	bf->dbl_val = float_val;
+	bf->replannable = true;
+	bf->entry_vmax = PASS_THROUGH_VMAX;
+	bf->cruise_vmax = PASS_THROUGH_VMAX;
+	bf->exit_vmax = PASS_THROUGH_VMAX;
+	mp_queue_write_buffer(MOVE_TYPE_INLINE_COMMAND);
+	return;
+}
+
+static stat_t _exec_inline_command(mpBuf_t *bf)
+{
+	st_prep_command(bf->cm_func, bf->int_val, bf->dbl_val);	// the loader fires it at the boundary
+	if ((bf->nx->buffer_state == MP_BUFFER_QUEUED) || (bf->nx->buffer_state == MP_BUFFER_PENDING)) {
+		bf->nx->replannable = false;	// the next block is about to run (see _exec_aline())
+	}
+	mp_free_run_buffer();
+	return (STAT_OK);
 }
 
 /*************************************************************************
@@ -288,6 +421,7 @@ static stat_t _exec_dwell(mpBuf_t *bf)
  *	(test, get and unget have no effect)
  * 
  * mp_get_planner_buffers_available()   Returns # of available planner buffers
+ * mp_get_planner_queue_ms()	Returns ms of movement & dwell queued ahead of the run buffer
  *
  * mp_init_buffers()		Initializes or resets buffers
  *
@@ -317,6 +451,70 @@ static stat_t _exec_dwell(mpBuf_t *bf)
 
 uint8_t mp_get_planner_buffers_available(void) { return (mb.buffers_available);}
 
+/*
+ * mp_get_planner_queue_ms() - read the time horizon
+ * mp_add_planner_queue_ms() - add to (or take from) the time horizon
+ *
+ *	mm.ms_in_queue is taken down by the exec interrupt as it takes buffers 
+ *	(mp_get_run_buffer()) and added to by the main loop as it queues them. A 
+ *	float is 4 bytes on the xmega, so the main loop holds the exec off to read
+ *	or update it, or the exec could change it half way and an update be lost.
+ */
+float mp_get_planner_queue_ms()
+{
+	st_exec_hold();
+	float ms = mm.ms_in_queue;
+	st_exec_release();
+	return (ms);
+}
+
+void mp_add_planner_queue_ms(const float ms)
+{
+	st_exec_hold();
+	mm.ms_in_queue += ms;
+	st_exec_release();
+}
+
+/*
+ * mp_get_planner_lookahead_ms() - ms queued behind the next block to run
+ *
+ *	The runtime freezes a block's plan when it loads it, so only what is queued
+ *	behind the next block to run can still shape that plan. Starting and reading
+ *	decisions use this, not mm.ms_in_queue - a long next block must never load 
+ *	without the block after it. The exec is held off while the run buffer and
+ *	the horizon are read (a no-op when the exec itself calls it).
+ */
+float mp_get_planner_lookahead_ms()
+{
+	float ms = 0;
+	st_exec_hold();
+	mpBuf_t *bf = mb.r;
+	if (bf->buffer_state == MP_BUFFER_RUNNING) { bf = bf->nx;}
+	if ((bf->buffer_state == MP_BUFFER_QUEUED) || (bf->buffer_state == MP_BUFFER_PENDING)) { 
+		ms = mm.ms_in_queue - _get_buffer_ms(bf);
+	}
+	st_exec_release();
+	return (ms);
+}
+
+/*
+ * _get_buffer_ms() - ms of movement or dwell a buffer adds to the time horizon
+ *
+ *	mm.ms_in_queue goes up as buffers are queued and down as the runtime takes 
+ *	them in mp_get_run_buffer(), so it covers the buffers ahead of the running one.
+ *	Code that changes the time of a queued line adjusts it as well (coalescing,
+ *	corner blends). Lines count their time at the requested feed rate - a little
+ *	short of the time they take once acceleration and overrides are in. It is 
+ *	zeroed whenever the queue drains, which also drops any rounding that has 
+ *	built up.
+ */
+static float _get_buffer_ms(const mpBuf_t *bf)
+{
+	if (mp_is_aline(bf) == true) { return (bf->time * 60000);}
+	if (bf->move_type == MOVE_TYPE_DWELL) { return (bf->time * 1000);}	// dwell time is in seconds
+	return (0);
+}
+
 void mp_init_buffers(void)
 {
 	mpBuf_t *pv;
@@ -336,6 +534,7 @@ void mp_init_buffers(void)
 		pv = &mb.bf[i];
 	}
 	mb.buffers_available = PLANNER_BUFFER_POOL_SIZE;
+	mm.ms_in_queue = 0;
 }
 
 mpBuf_t * mp_get_write_buffer() 				// get & clear a buffer
@@ -367,6 +566,8 @@ void mp_queue_write_buffer(const uint8_t move_type)
 	mb.q->move_type = move_type;
 	mb.q->move_state = MOVE_STATE_NEW;
 	mb.q->buffer_state = MP_BUFFER_QUEUED;
+	if (mb.q == mb.r) { mb.start_ticks = rtc.clock_ticks;}	// first in an empty queue (see _startup_hold())
+	mp_add_planner_queue_ms(_get_buffer_ms(mb.q));
 	mb.q = mb.q->nx;							// advance the queued buffer pointer
 	st_request_exec_move();						// request a move exec if not busy
 	rpt_request_queue_report(+1);				// add to the "added buffers" count
@@ -378,6 +579,7 @@ mpBuf_t * mp_get_run_buffer()
 	if ((mb.r->buffer_state == MP_BUFFER_QUEUED) || 
 		(mb.r->buffer_state == MP_BUFFER_PENDING)) {
 		 mb.r->buffer_state = MP_BUFFER_RUNNING;
+		 mm.ms_in_queue -= _get_buffer_ms(mb.r);	// it is the runtime's now
 	}
 	// condition: asking for the same run buffer for the Nth time
 	if (mb.r->buffer_state == MP_BUFFER_RUNNING) {	// return same buffer
@@ -394,7 +596,10 @@ void mp_free_run_buffer()						// EMPTY current run buf & adv to next
 	if (mb.r->buffer_state == MP_BUFFER_QUEUED) {// only if queued...
 		mb.r->buffer_state = MP_BUFFER_PENDING;  // pend next buffer
 	}
-	if (mb.w == mb.r) cm_cycle_end();			// end the cycle if the queue empties
+	if (mb.w == mb.r) {							// the queue has emptied
+		mm.ms_in_queue = 0;						// drop any rounding in the time horizon
+		mb.end_pending = true;					// mp_stop_callback() ends the cycle
+	}
 	mb.buffers_available++;
 	rpt_request_queue_report(-1);				// add to the "removed buffers" count
 }
@@ -478,7 +683,6 @@ static void _dump_plan_buffer(mpBuf_t *bf)
 	print_scalar(PSTR("line number:     "), bf->linenum);
 	print_vector(PSTR("position:        "), mm.position, AXES);
 	print_vector(PSTR("target:          "), bf->target, AXES);
-	print_vector(PSTR("unit:            "), bf->unit, AXES);
 	print_scalar(PSTR("jerk:            "), bf->jerk);
 	print_scalar(PSTR("time:            "), bf->time);
 	print_scalar(PSTR("length:          "), bf->length);
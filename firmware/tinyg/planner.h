@@ -31,8 +31,10 @@
 enum moveType {				// bf->move_type values 
 	MOVE_TYPE_NULL = 0,		// null move - does a no-op
 	MOVE_TYPE_ALINE,		// acceleration planned line
+	MOVE_TYPE_ARC,			// acceleration planned arc or helix (runs as an aline - see mp_arc())
 	MOVE_TYPE_DWELL,		// delay with no movement
 	MOVE_TYPE_COMMAND,		// general command
+	MOVE_TYPE_INLINE_COMMAND,// command that is planned through without stopping
 	MOVE_TYPE_TOOL,			// T command
 	MOVE_TYPE_SPINDLE_SPEED,// S command
 	MOVE_TYPE_STOP,			// program stop
@@ -52,55 +54,133 @@ enum moveState {
 };
 #define MOVE_STATE_RUN1 MOVE_STATE_RUN // a convenience
 
+enum mpFeedOverrideState {		// mr.feed_override_state values
+	FEED_OVERRIDE_OFF = 0,		// no override replan pending
+	FEED_OVERRIDE_SYNC,			// feed or traverse override changed - sync to the next aline segment
+	FEED_OVERRIDE_PLAN			// replan the running block and the queue for the override
+};
+
+enum mpPreloadState {			// mr.preload_state values
+	PRELOAD_OFF = 0,			// shadow runtime (ms) is empty
+	PRELOAD_PENDING,			// next block is planned - load it on a later exec
+	PRELOAD_READY				// ms holds the next block, ready to swap in at the boundary
+};
+
 /*** Most of these factors are the result of a lot of tweaking. Change with caution.***/
 
 /* The following must apply:
  *	  MM_PER_ARC_SEGMENT >= MIN_LINE_LENGTH >= MIN_SEGMENT_LENGTH 
  */
-#define ARC_SEGMENT_LENGTH 		((float)0.1)		// Arc segment size (mm).(0.03)
+#define ARC_SEGMENT_LENGTH 		((float)0.1)		// Shortest arc drawn ($ma, mm). Arcs are cut by the runtime (0.03)
 #define MIN_LINE_LENGTH 		((float)0.08)		// Smallest line the system can plan (mm) (0.02)
 #define MIN_SEGMENT_LENGTH 		((float)0.05)		// Smallest accel/decel segment (mm). Set to produce ~10 ms segments (0.01)
 #define MIN_LENGTH_MOVE 		((float)0.001)		// millimeters
 
 #define JERK_MATCH_PRECISION 1000	// precision to which jerk must match to be considered effectively the same
+#ifndef JERK_CACHE_SIZE
+#define JERK_CACHE_SIZE 4			// jerk terms kept for re-use (see _set_jerk_terms())
+#endif
+#define JUNCTION_DELTA_UNKNOWN ((float)-1)	// junction delta not computed yet (see _get_junction_vmax())
+
+#define COALESCE_TOLERANCE		((float)0.001)		// collinear line coalescing tolerance (mm). 0 turns it off
+#define COALESCE_USEC_MAX		((float)500000)		// longest block that line coalescing will build
+#define COALESCE_VELOCITY_MATCH	((float)0.0001)		// feed rates within this fraction are the same feed
+
+#define BLEND_SEGMENTS_MAX		3					// most lines a G64 P corner blend is built from
+#define BLEND_SEGMENT_ANGLE		((float)0.3927)		// direction change per blend line (radians, 22.5 deg)
+#define BLEND_VELOCITY_GAIN		((float)1.3)		// a blend must be this much faster than the vertex to pay off
+
+#define FEED_OVERRIDE_MIN		((float)0.1)		// slowest feed rate override factor
+#define FEED_OVERRIDE_MAX		((float)2.0)		// fastest feed rate override factor
+#define FEED_OVERRIDE_STEP		((float)0.1)		// factor change per realtime override character
+#define TRAVERSE_OVERRIDE_MIN	((float)0.1)		// slowest traverse override factor (the fastest is 1)
+
+#define HOLD_LENGTH_FIT_TOLERANCE ((float)0.01)	// a feedhold stop this much (fraction) too long for a move still fits it
+
+#define PASS_THROUGH_VMAX		((float)12345678)	// vmax of blocks the planner plans straight through (inline commands)
 
 /* ESTD_SEGMENT_USEC	 Microseconds per planning segment
  *	Should be experimentally adjusted if the MIN_SEGMENT_LENGTH is changed
  */
 #define NOM_SEGMENT_USEC 		((float)5000)		// nominal segment time
 #define MIN_SEGMENT_USEC 		((float)2500)		// minimum segment time
-#define MIN_ARC_SEGMENT_USEC	((float)10000)		// minimum arc segment time
+#define MAX_SEGMENT_USEC 		((float)10000)		// body segment time ($mx). Keep within ACCUMULATOR_RESET_FACTOR of $ms
+#define SEGMENT_VELOCITY_STEP	((float)100)		// largest velocity change per head or tail segment (mm/min)
+#define MIN_ARC_SEGMENT_USEC	((float)10000)		// minimum corner blend line time (was the arc segment time)
+#ifndef ARC_CORRECTION_SEGMENTS
+#define ARC_CORRECTION_SEGMENTS	16					// arc points placed by rotation between exact (trig) ones
+#endif
+#define ARC_ROTATION_MAX		((float)0.5)		// largest segment rotation taken from the series (radians)
+#ifndef PRELOAD_SEGMENTS
+#define PRELOAD_SEGMENTS		3					// preload the next block this many segments before the boundary
+#endif
 
 //derived from above
 #define NOM_SEGMENT_TIME 		(MIN_SEGMENT_USEC / MICROSECONDS_PER_MINUTE)
 #define MIN_SEGMENT_TIME 		(MIN_SEGMENT_USEC / MICROSECONDS_PER_MINUTE)
 #define MIN_ARC_SEGMENT_TIME 	(MIN_ARC_SEGMENT_USEC / MICROSECONDS_PER_MINUTE)
+#define COALESCE_TIME_MAX		(COALESCE_USEC_MAX / MICROSECONDS_PER_MINUTE)
 #define MIN_TIME_MOVE  			MIN_SEGMENT_USEC	// minimum time a move can be is one segment
 
 /* PLANNER_STARTUP_DELAY_SECONDS
- *	Used to introduce a short dwell before planning an idle machine.
+ *	Used to introduce a short delay before starting an idle machine.
  *  If you don;t do this the first block will always plan to zero as it will
  *	start executing before the next block arrives from the serial port.
  *	This cuases the machine to stutter once on startup.
+ *	The delay is adaptive: motion starts as soon as PLANNER_STARTUP_MS of it
+ *	is queued, and the delay is only the longest it will wait (see mp_exec_move())
+ *
+ * PLANNER_HORIZON_MAX_MS and PLANNER_HORIZON_LOW_MS
+ *	Bounds on the time horizon - the ms of motion queued ahead of the running 
+ *	block (mm.ms_in_queue). Above MAX queued behind the next block to run the 
+ *	controller stops reading lines, as the planner already sees far enough 
+ *	ahead. Below LOW a moving machine is running the queue dry and new lines 
+ *	are slowed down (see mp_aline()).
  */
 #define PLANNER_STARTUP_DELAY_SECONDS 0.05	// in seconds
+#define PLANNER_STARTUP_MS		((float)250)		// queued motion that starts an idle machine at once
+#define PLANNER_HORIZON_MAX_MS	((float)2000)		// stop reading lines above this much queued motion
+#define PLANNER_HORIZON_LOW_MS	((float)250)		// slow down new lines below this much queued motion
 
 /* PLANNER_BUFFER_POOL_SIZE
  *	Should be at least the number of buffers requires to support optimal 
- *	planning in the case of very short lines or arc segments. 
+ *	planning in the case of very short lines (arcs take one buffer each). 
  *	Suggest 12 min. Limit is 255
+ *	Can be overridden at compile time, e.g. to size buffers in the simulator.
+ *
+ *	SRAM budget. Static RAM is already most of the xmega's 16K, so the planner 
+ *	and stepper structures are held to what build 380.08 used for them and the 
+ *	pool gets whatever the rest leaves. AVR bytes (1 byte alignment, 2 byte 
+ *	pointers):
+ *
+ *						380.08			now
+ *		mpBuf_t			158				127	(no unit, work offset or arc center per block)
+ *		mb - buffers	11				18
+ *		mm				40				219	(junction, coalescing and jerk terms)
+ *		mr				203				280	(arc and section end state)
+ *		ms				-				280	(shadow runtime - see mp_preload_move())
+ *		ar				172				-	(arcs plan as single blocks)
+ *		sps				40				177	(prep ring of 4, inline commands)
+ *		cfg, cm, gm, qr	-				65	(derived jerk terms, G64 P, overrides)
+ *		total			466 + 158/buf	1039 + 127/buf
+ *
+ *	30 buffers fit (4849 bytes against 4890), two more than 380.08 had, and each 
+ *	holds more motion: an arc takes one buffer, not one per segment. Most of the 
+ *	bytes each buffer gave up went to ms and the prep ring; the arc state shares
+ *	its space with the command callback.
  */
-#define PLANNER_BUFFER_POOL_SIZE 28
-#define PLANNER_BUFFER_HEADROOM 4			// buffers to reserve in planner before processing new input line
+#ifndef PLANNER_BUFFER_POOL_SIZE
+#define PLANNER_BUFFER_POOL_SIZE 30
+#endif
+#define PLANNER_BUFFER_HEADROOM (2+BLEND_SEGMENTS_MAX)	// buffers to reserve before processing a new input line:
+												// work offset, corner blend and the line itself
 
 /* Some parameters for _generate_trapezoid()
- * TRAPEZOID_ITERATION_MAX	 			Max iterations for convergence in the HT asymmetric case.
- * TRAPEZOID_ITERATION_ERROR_PERCENT	Error percentage for iteration convergence. As percent - 0.01 = 1%
+ * TRAPEZOID_ITERATION_MAX	 			Max Newton steps in the HT asymmetric case.
  * TRAPEZOID_LENGTH_FIT_TOLERANCE		Tolerance for "exact fit" for H and T cases
  * TRAPEZOID_VELOCITY_TOLERANCE			Adaptive velocity tolerance term
  */
 #define TRAPEZOID_ITERATION_MAX 10
-#define TRAPEZOID_ITERATION_ERROR_PERCENT 0.10
 #define TRAPEZOID_LENGTH_FIT_TOLERANCE (0.0001)	// allowable mm of error in planning phase
 #define TRAPEZOID_VELOCITY_TOLERANCE (max(2,bf->entry_velocity/100))
 
@@ -131,7 +211,6 @@ typedef struct mpBuffer {		// See Planning Velocity Notes for variable usage
 	struct mpBuffer *pv;		// static pointer to previous buffer
 	struct mpBuffer *nx;		// static pointer to next buffer
 	stat_t (*bf_func)(struct mpBuffer *bf); // callback to buffer exec function - passes *bf, returns stat_t
-	cm_exec cm_func;			// callback to canonical machine execution function
 	uint32_t linenum;			// runtime line number; or line index if not numbered
 	uint8_t motion_mode;		// runtime motion mode for status reporting
 	uint8_t buffer_state;		// used to manage queueing/dequeueing
@@ -139,10 +218,10 @@ typedef struct mpBuffer {		// See Planning Velocity Notes for variable usage
 	uint8_t move_code;			// byte that can be used by used exec functions
 	uint8_t move_state;			// move state machine sequence
 	uint8_t replannable;		// TRUE if move can be replanned
+	uint8_t axes;				// axes the line moves - bit i is set for axis i
 
 	float target[AXES];			// target position in floating point
-	float unit[AXES];			// unit vector for axis scaling & planning
-	float work_offset[AXES];	// offset from the work coordinate system (for reporting only)
+								// (unit vector and work offset are not kept per block - see mp_aline())
 
 	float time;					// line, helix or dwell time in minutes
 	float min_time;				// minimum time for the move - for rate override replanning
@@ -155,6 +234,7 @@ typedef struct mpBuffer {		// See Planning Velocity Notes for variable usage
 	float cruise_velocity;		// cruise velocity requested & achieved
 	float exit_velocity;		// exit velocity requested for the move
 
+	float junction_vmax;		// max junction velocity before the cruise cap (for override replanning)
 	float entry_vmax;			// max junction velocity at entry of this move
 	float cruise_vmax;			// max cruise velocity requested for move
 	float exit_vmax;			// max exit velocity possible (redundant)
@@ -164,6 +244,17 @@ typedef struct mpBuffer {		// See Planning Velocity Notes for variable usage
 	float jerk;					// maximum linear jerk term for this move
 	float recip_jerk;			// 1/Jm used for planning (compute-once)
 	float cbrt_jerk;			// cube root of Jm used for planning (compute-once)
+
+	union {						// a command is never an arc, so they share the space
+		cm_exec cm_func;		// callback to canonical machine execution function
+		struct {				// arcs only - see mp_arc()
+			uint8_t axis_1;		// arc plane axes
+			uint8_t axis_2;
+			float radius;		// arc radius (the center is found from the target - see _get_arc_center())
+			float theta;		// arc angle at the target
+			float angular_rate;	// radians of arc per mm of path (+CW, -CCW)
+		};
+	};
 } mpBuf_t;
 
 typedef struct mpBufferPool {	// ring buffer for sub-moves
@@ -172,16 +263,36 @@ typedef struct mpBufferPool {	// ring buffer for sub-moves
 	mpBuf_t *w;					// get_write_buffer pointer
 	mpBuf_t *q;					// queue_write_buffer pointer
 	mpBuf_t *r;					// get/end_run_buffer pointer
+	uint32_t start_ticks;		// RTC time the first line was queued to an idle runtime
+	uint8_t start_held;			// TRUE while a start waits for the queue (see _startup_hold())
+	uint8_t hold_pending;		// TRUE from the end of a hold's decel until the steppers stop
+	uint8_t end_pending;		// TRUE from the queue emptying until the steppers stop
 	mpBuf_t bf[PLANNER_BUFFER_POOL_SIZE];// buffer storage
 	uint16_t magic_end;
 } mpBufferPool_t;
 
+typedef struct mpJerkTerms {		// compute-once jerk terms kept for re-use
+	float jerk;
+	float recip_jerk;
+	float cbrt_jerk;
+} mpJerkTerms_t;
+
 typedef struct mpMoveMasterSingleton {	// common variables for planning (move master)
 	float position[AXES];		// final move position for planning purposes
-	float ms_in_queue;			// total ms of movement & dwell in planner queue
-	float prev_jerk;			// jerk values cached from previous move
-	float prev_recip_jerk;
-	float prev_cbrt_jerk;
+	float unit[AXES];			// unit vector of the last queued line (for junction planning)
+	float work_offset[AXES];	// last work offset queued to the runtime
+	float coalesce_start[AXES];	// start of the last queued line (see _coalesce_line())
+	float coalesce_unit[AXES];	// direction the last queued line started along
+	float coalesce_pv_unit[AXES];// unit vector of the line before it
+	float coalesce_pv_delta;	// fused junction deviation of coalesce_pv_unit
+	float junction_delta;		// fused junction deviation of unit (see _get_junction_vmax())
+	float coalesce_along;		// distance the last queued line reaches along coalesce_unit
+	float ms_in_queue;			// total ms of movement & dwell queued and not yet started
+	uint8_t jerk_next;			// jerk cache slot to replace on the next miss
+	mpJerkTerms_t jerk_cache[JERK_CACHE_SIZE];	// jerk terms of recent moves
+	float feed_override_factor;	// feed rate override in effect for planning (1 = none)
+	float traverse_override_factor;// traverse override in effect for planning (1 = none)
+	struct mpBuffer *hold_replan;// first block to replan behind a feedhold (see mp_plan_hold_callback())
 #ifdef __UNIT_TEST_PLANNER
 	float test_case;
 	float test_velocity;
@@ -197,8 +308,16 @@ typedef struct mpMoveRuntimeSingleton {	// persistent runtime variables
 	uint8_t motion_mode;		// runtime motion mode for status reports
 	uint8_t move_state;			// state of the overall move
 	uint8_t section_state;		// state within a move section
+	uint8_t feed_override_state;// feed override replan sub-state machine
+	uint8_t axes;				// axes the move runs - bit i is set for axis i
+	uint8_t preload_state;		// shadow runtime state (see mp_preload_move())
+	struct mpBuffer *preload_bf;// block loaded into the shadow runtime
+	uint8_t move_type;			// MOVE_TYPE_ALINE or MOVE_TYPE_ARC
+	uint8_t axis_1;				// arc plane axes (copies of bf variables of same name)
+	uint8_t axis_2;
+	uint8_t correction_count;	// arc segments to the next exact point (see _set_arc_target())
 
-	float endpoint[AXES];		// final target for bf (used to correct rounding errors)
+	float endpoint[AXES];		// final target for bf (where the last section ends)
 	float position[AXES];		// current move position
 	float target[AXES];			// target move position
 	float unit[AXES];			// unit vector for axis scaling & planning
@@ -221,17 +340,63 @@ typedef struct mpMoveRuntimeSingleton {	// persistent runtime variables
 	float segment_move_time;	// actual time increment per aline segment
 	float microseconds;			// line or segment time in microseconds
 	float segment_length;		// computed length for aline segment
-	float segment_velocity;		// computed velocity for aline segment
-	float forward_diff_1;      // forward difference level 1 (Acceleration)
-	float forward_diff_2;      // forward difference level 2 (Jerk - constant)
+	float segment_velocity;		// computed velocity for aline segment (average over the segment)
+	float section_remaining;	// distance left to the end of the running section
+	float section_end[AXES];	// position where the running section ends
+	float forward_diff_1;      // forward difference level 1 (length of the next segment)
+	float forward_diff_2;      // forward difference level 2
+	float forward_diff_3;      // forward difference level 3 (Jerk - constant)
+
+	float center_1;				// arc center, radius and rate (copies of bf variables)
+	float center_2;
+	float radius;
+	float angular_rate;
+	float theta;				// arc angle of the last target
+	float endpoint_theta;		// arc angle at the endpoint
+	float section_end_theta;	// arc angle at the section end
+	float offset_1;				// last target from the center on axis_1...
+	float offset_2;				// ...and on axis_2
 	uint16_t magic_end;
 } mpMoveRuntimeSingleton_t;
 
 
+/* Planner statistics
+ *	Counters for profiling the planner. Define __PLANNER_STATS (tinyg.h, or 
+ *	"make bench" in sim/) to compile them in. They cost RAM and cycles in the 
+ *	planning path so they are off in normal builds.
+ */
+#ifdef __PLANNER_STATS
+typedef struct mpPlannerStatistics {
+	uint32_t blocks;				// blocks committed by mp_aline() and mp_arc()
+	uint32_t arcs;					// ...of which were arcs
+	uint32_t plan_visits;			// buffers visited by _plan_block_list() (both passes)
+	uint32_t plan_replans;			// blocks replanned by _plan_block_list() (forward pass)
+	uint32_t plan_converged;		// backward passes stopped early on a converged block
+	uint32_t coalesced;				// lines taken into the last queued block by _coalesce_line()
+	uint32_t blended;				// corners cut by _blend_corner() (G64 P)
+	uint32_t jerk_hits;				// jerk terms taken from the jerk cache
+	uint32_t jerk_misses;			// jerk terms computed (cbrt and reciprocal)
+	uint32_t trapezoids;			// calls to _calculate_trapezoid()
+	uint32_t segments;				// aline segments prepped for the steppers
+	uint32_t boundaries;			// aline blocks started by the runtime
+	uint32_t preloads;				// ...of which were swapped in from the shadow runtime
+	uint32_t ht_asymmetric;			// rate-limited HT' (asymmetric) cases
+	uint32_t ht_iterations;			// successive approximation passes in HT' cases
+	uint32_t holds;					// feedholds planned by mp_plan_hold_callback()
+	uint32_t hold_blocks;			// ...blocks planned into their decelerations
+	uint32_t hold_queue_blocks;		// ...blocks replanned behind them (_plan_hold_queue())
+} mpPlannerStatistics_t;
+mpPlannerStatistics_t mps;
+#define MP_STAT(stmt) stmt
+#else
+#define MP_STAT(stmt)
+#endif
+
 // Allocate global scope structs
 mpBufferPool_t mb;				// move buffer queue
 mpMoveMasterSingleton_t mm;		// context for line planning
 mpMoveRuntimeSingleton_t mr;	// context for line runtime
+mpMoveRuntimeSingleton_t ms;	// shadow runtime - the next block, preloaded (see mp_preload_move())
 
 /*
  * Global Scope Functions
@@ -247,16 +412,27 @@ void mp_set_axes_position(const float position[]);
 void mp_set_axis_position(uint8_t axis, const float position);
 
 stat_t mp_exec_move(void);
+stat_t mp_preload_move(void);
 void mp_queue_command(void(*cm_exec)(uint8_t, float), uint8_t int_val, float float_val);
+void mp_queue_inline_command(void(*cm_exec)(uint8_t, float), uint8_t int_val, float float_val);
 stat_t mp_dwell(const float seconds);
 void mp_end_dwell(void);
 stat_t mp_aline(const float target[], const float minutes, const float work_offset[], const float min_time);
+stat_t mp_arc(const float target[], const float theta, const float radius, const float angular_travel,
+			  const uint8_t axis_1, const uint8_t axis_2, const float minutes, const float work_offset[], const float min_time);
 stat_t mp_plan_hold_callback(void);
 stat_t mp_end_hold(void);
 stat_t mp_feed_rate_override(uint8_t flag, float parameter);
+stat_t mp_traverse_override(uint8_t flag, float parameter);
+stat_t mp_plan_override_callback(void);
 
 // planner buffer handlers
 uint8_t mp_get_planner_buffers_available(void);
+float mp_get_planner_queue_ms(void);
+void mp_add_planner_queue_ms(const float ms);
+float mp_get_planner_lookahead_ms(void);
+stat_t mp_start_callback(void);
+stat_t mp_stop_callback(void);
 void mp_clear_buffer(mpBuf_t *bf); 
 void mp_copy_buffer(mpBuf_t *bf, const mpBuf_t *bp);
 void mp_queue_write_buffer(const uint8_t move_type);
@@ -267,6 +443,7 @@ mpBuf_t * mp_get_first_buffer(void);
 mpBuf_t * mp_get_last_buffer(void);
 #define mp_get_prev_buffer(b) ((mpBuf_t *)(b->pv))
 #define mp_get_next_buffer(b) ((mpBuf_t *)(b->nx))
+#define mp_is_aline(b) (((b)->move_type == MOVE_TYPE_ALINE) || ((b)->move_type == MOVE_TYPE_ARC))	// arcs run as alines
 
 // plan_line.c functions
 uint8_t mp_isbusy(void);
@@ -429,6 +429,7 @@ struct qrIndexes {				// static data for queue reports
 	uint8_t prev_available;		// used to filter reports
 	uint8_t buffers_added;		// buffers added since last report
 	uint8_t buffers_removed;	// buffers removed since last report
+	float ms_in_queue;			// time horizon: ms of motion queued (see mp_get_planner_queue_ms())
 };
 static struct qrIndexes qr;
 
@@ -445,6 +446,7 @@ void rpt_request_queue_report(int8_t buffers)
 	if (cfg.queue_report_verbosity == QR_OFF) return;
 
 	qr.buffers_available = mp_get_planner_buffers_available();
+	qr.ms_in_queue = max(mp_get_planner_queue_ms(), 0);
 
 	if (buffers > 0) {
 		qr.buffers_added += buffers;
@@ -473,15 +475,15 @@ uint8_t rpt_queue_report_callback()
 
 	if (cfg.comm_mode == TEXT_MODE) {
 		if (cfg.queue_report_verbosity == QR_VERBOSE) {
-			fprintf(stderr, "qr:%d\n", qr.buffers_available);
+			fprintf(stderr, "qr:%d,qt:%1.0f\n", qr.buffers_available, qr.ms_in_queue);
 		} else  if (cfg.queue_report_verbosity == QR_TRIPLE) {
-			fprintf(stderr, "qr:%d,added:%d,removed:%d\n", qr.buffers_available, qr.buffers_added,qr.buffers_removed);
+			fprintf(stderr, "qr:%d,added:%d,removed:%d,qt:%1.0f\n", qr.buffers_available, qr.buffers_added,qr.buffers_removed, qr.ms_in_queue);
 		}
 	} else {
 		if (cfg.queue_report_verbosity == QR_VERBOSE) {
-			fprintf(stderr, "{\"qr\":%d}\n", qr.buffers_available);
+			fprintf(stderr, "{\"qr\":%d,\"qt\":%1.0f}\n", qr.buffers_available, qr.ms_in_queue);
 		} else  if (cfg.queue_report_verbosity == QR_TRIPLE) {
-			fprintf(stderr, "{\"qr\":[%d,%d,%d]}\n", qr.buffers_available, qr.buffers_added,qr.buffers_removed);
+			fprintf(stderr, "{\"qr\":[%d,%d,%d],\"qt\":%1.0f}\n", qr.buffers_available, qr.buffers_added,qr.buffers_removed, qr.ms_in_queue);
 			rpt_clear_queue_report();
 		}
 	}
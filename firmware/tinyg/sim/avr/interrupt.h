@@ -0,0 +1,27 @@
+/*
+ * avr/interrupt.h - host simulation stand-in for ISR declarations
+ * Part of TinyG project
+ *
+ * Copyright (c) 2013 Alden S. Hart Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ * ISR(vect) declares an ordinary function named after the vector so the virtual 
+ * clock in sim.c can call it directly. Vectors the simulator never fires still
+ * compile, they are just never called.
+ */
+#ifndef sim_avr_interrupt_h
+#define sim_avr_interrupt_h
+
+#include "io.h"
+
+#define ISR(vect) void vect(void); void vect(void)
+
+#define sei() (SREG |= 0x80)
+#define cli() (SREG &= ~0x80)
+
+#endif // sim_avr_interrupt_h
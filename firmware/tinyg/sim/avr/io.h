@@ -0,0 +1,296 @@
+/*
+ * avr/io.h - host simulation stand-in for the xmega register file
+ * Part of TinyG project
+ *
+ * Copyright (c) 2013 Alden S. Hart Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * This header is only on the include path for the tinyg_sim build (see sim/Makefile).
+ * It replaces the avr-libc device header with plain memory-backed register structs
+ * so the firmware sources compile unchanged on a host. Only the registers and bit
+ * definitions the firmware actually touches are provided. The timer registers are
+ * read back by the virtual clock in sim.c, which fires the corresponding ISRs.
+ *
+ * Register layouts are simplified - field names match the xmega so the code compiles,
+ * but offsets and sizes do not. Nothing here should be used for address arithmetic.
+ */
+#ifndef sim_avr_io_h
+#define sim_avr_io_h
+
+#include <stdint.h>
+
+typedef volatile uint8_t register8_t;
+typedef volatile uint16_t register16_t;
+
+/**** Ports ****/
+
+typedef struct PORT_struct {
+	register8_t DIR;
+	register8_t DIRSET;
+	register8_t DIRCLR;
+	register8_t DIRTGL;
+	register8_t OUT;
+	register8_t OUTSET;
+	register8_t OUTCLR;
+	register8_t OUTTGL;
+	register8_t IN;
+	register8_t INTCTRL;
+	register8_t INT0MASK;
+	register8_t INT1MASK;
+	register8_t INTFLAGS;
+	register8_t PIN0CTRL;
+	register8_t PIN1CTRL;
+	register8_t PIN2CTRL;
+	register8_t PIN3CTRL;
+	register8_t PIN4CTRL;
+	register8_t PIN5CTRL;
+	register8_t PIN6CTRL;
+	register8_t PIN7CTRL;
+} PORT_t;
+
+typedef struct VPORT_struct {
+	register8_t DIR;
+	register8_t OUT;
+	register8_t IN;
+	register8_t INTFLAGS;
+} VPORT_t;
+
+typedef struct PORTCFG_struct {
+	register8_t MPCMASK;
+	register8_t VPCTRLA;
+	register8_t VPCTRLB;
+	register8_t CLKEVOUT;
+} PORTCFG_t;
+
+extern PORT_t PORTA, PORTB, PORTC, PORTD, PORTE, PORTF;
+extern VPORT_t VPORT0, VPORT1, VPORT2, VPORT3;
+extern PORTCFG_t PORTCFG;
+
+#define PORTCFG_VP0MAP_PORTA_gc 0x00
+#define PORTCFG_VP0MAP_PORTD_gc 0x03
+#define PORTCFG_VP1MAP_PORTF_gc 0x50
+#define PORTCFG_VP2MAP_PORTE_gc 0x04
+#define PORTCFG_VP3MAP_PORTD_gc 0x30
+
+#define PORT_OPC_TOTEM_gc		(0x00<<3)
+#define PORT_OPC_PULLUP_gc		(0x03<<3)
+#define PORT_ISC_BOTHEDGES_gc	(0x00<<0)
+#define PORT_ISC_RISING_gc		(0x01<<0)
+#define PORT_ISC_FALLING_gc		(0x02<<0)
+#define PORT_INT0LVL_gm			0x03
+#define PORT_INT0LVL_LO_gc		(0x01<<0)
+#define PORT_INT0LVL_MED_gc		(0x02<<0)
+#define PORT_INT0LVL_HI_gc		(0x03<<0)
+#define PORT_INT1LVL_gm			0x0C
+#define PORT_INT1LVL_LO_gc		(0x01<<2)
+#define PORT_INT1LVL_MED_gc		(0x02<<2)
+#define PORT_INT1LVL_HI_gc		(0x03<<2)
+
+/**** Timer/counters ****/
+
+typedef struct TC0_struct {
+	register8_t CTRLA;
+	register8_t CTRLB;
+	register8_t CTRLC;
+	register8_t CTRLD;
+	register8_t CTRLE;
+	register8_t INTCTRLA;
+	register8_t INTCTRLB;
+	register8_t CTRLFCLR;
+	register8_t CTRLFSET;
+	register8_t CTRLGCLR;
+	register8_t CTRLGSET;
+	register8_t INTFLAGS;
+	register8_t TEMP;
+	register16_t CNT;
+	register16_t PER;
+	register16_t CCA;
+	register16_t CCB;
+	register16_t CCC;
+	register16_t CCD;
+	register16_t PERBUF;
+	register16_t CCABUF;
+	register16_t CCBBUF;
+	register16_t CCCBUF;
+	register16_t CCDBUF;
+} TC0_t;
+
+typedef TC0_t TC1_t;
+
+extern TC0_t TCC0, TCD0, TCE0, TCF0;
+extern TC1_t TCC1, TCD1, TCE1;
+
+#define TC_CLKSEL_OFF_gc		0x00
+#define TC_CLKSEL_DIV1_gc		0x01
+#define TC_CLKSEL_DIV2_gc		0x02
+#define TC_CLKSEL_DIV4_gc		0x03
+#define TC_CLKSEL_DIV8_gc		0x04
+#define TC_CLKSEL_DIV64_gc		0x05
+#define TC_CLKSEL_DIV256_gc		0x06
+#define TC_CLKSEL_DIV1024_gc	0x07
+#define TC_WGMODE_SS_gc			0x03
+#define TC1_CCBEN_bm			0x20
+#define TC0_CCBEN_bm			0x20
+#define TC_OVFINTLVL_LO_gc		0x01
+#define TC_OVFINTLVL_MED_gc		0x02
+#define TC_OVFINTLVL_HI_gc		0x03
+#define TC_OVFINTLVL_OFF_gc		0x00
+
+/**** USARTs ****/
+
+typedef struct USART_struct {
+	register8_t DATA;
+	register8_t STATUS;
+	register8_t CTRLA;
+	register8_t CTRLB;
+	register8_t CTRLC;
+	register8_t BAUDCTRLA;
+	register8_t BAUDCTRLB;
+} USART_t;
+
+extern USART_t USARTC0, USARTC1;
+
+#define USART_RXCIF_bm			0x80
+#define USART_TXCIF_bm			0x40
+#define USART_DREIF_bm			0x20
+#define USART_RXEN_bm			0x10
+#define USART_TXEN_bm			0x08
+#define USART_CLK2X_bm			0x04
+#define USART_CHSIZE_8BIT_gc	0x03
+#define USART_RXCINTLVL_MED_gc	(0x02<<4)
+#define USART_TXCINTLVL_LO_gc	(0x01<<2)
+#define USART_DREINTLVL_LO_gc	(0x01<<0)
+#define USART_DREINTLVL_gm		0x03
+#define USART_TXCINTLVL_gm		0x0C
+
+/**** SPI ****/
+
+typedef struct SPI_struct {
+	register8_t CTRL;
+	register8_t INTCTRL;
+	register8_t STATUS;
+	register8_t DATA;
+} SPI_t;
+
+extern SPI_t SPIC, SPID;
+
+#define SPI_IF_bm				0x80
+#define SPI_ENABLE_bm			0x40
+#define SPI_MASTER_bm			0x10
+
+/**** System blocks ****/
+
+typedef struct RTC_struct {
+	register8_t CTRL;
+	register8_t STATUS;
+	register8_t INTCTRL;
+	register8_t INTFLAGS;
+	register8_t TEMP;
+	register16_t CNT;
+	register16_t PER;
+	register16_t COMP;
+} RTC_t;
+
+typedef struct OSC_struct {
+	register8_t CTRL;
+	register8_t STATUS;
+	register8_t XOSCCTRL;
+	register8_t XOSCFAIL;
+	register8_t RC32KCAL;
+	register8_t PLLCTRL;
+	register8_t DFLLCTRL;
+} OSC_t;
+
+typedef struct CLK_struct {
+	register8_t CTRL;
+	register8_t PSCTRL;
+	register8_t LOCK;
+	register8_t RTCCTRL;
+} CLK_t;
+
+typedef struct PMIC_struct {
+	register8_t STATUS;
+	register8_t INTPRI;
+	register8_t CTRL;
+} PMIC_t;
+
+typedef struct RST_struct {
+	register8_t STATUS;
+	register8_t CTRL;
+} RST_t;
+
+typedef struct SLEEP_struct {
+	register8_t CTRL;
+} SLEEP_t;
+
+typedef struct WDT_struct {
+	register8_t CTRL;
+	register8_t WINCTRL;
+	register8_t STATUS;
+} WDT_t;
+
+typedef struct NVM_struct {
+	register8_t ADDR0;
+	register8_t ADDR1;
+	register8_t ADDR2;
+	register8_t DATA0;
+	register8_t DATA1;
+	register8_t DATA2;
+	register8_t CMD;
+	register8_t CTRLA;
+	register8_t CTRLB;
+	register8_t INTCTRL;
+	register8_t STATUS;
+	register8_t LOCKBITS;
+} NVM_t;
+
+extern RTC_t RTC;
+extern OSC_t OSC;
+extern CLK_t CLK;
+extern PMIC_t PMIC;
+extern RST_t RST;
+extern SLEEP_t SLEEP;
+extern WDT_t WDT;
+extern NVM_t NVM;
+extern register8_t CCP;
+extern register8_t SREG;
+
+#define NVM_CMD NVM.CMD
+#define NVM_CTRLA NVM.CTRLA
+#define NVM_CMD_NO_OPERATION_gc		0x00
+#define NVM_CMD_READ_CALIB_ROW_gc	0x02
+#define NVM_NVMBUSY_bm				0x80
+
+#define RTC_SYNCBUSY_bm				0x01
+#define RTC_PRESCALER_DIV1_gc		0x01
+#define RTC_COMPINTLVL_LO_gc		(0x01<<2)
+#define RTC_COMPINTLVL_MED_gc		(0x02<<2)
+#define RTC_COMPINTLVL_HI_gc		(0x03<<2)
+#define RTC_OVFINTLVL_OFF_gc		0x00
+#define RTC_OVFINTLVL_LO_gc			0x01
+#define CLK_RTCSRC_RCOSC_gc			(0x02<<1)
+#define CLK_RTCEN_bm				0x01
+#define OSC_RC32KEN_bm				0x04
+#define OSC_RC32KRDY_bm				0x04
+
+#define PMIC_HILVLEN_bm				0x04
+#define PMIC_MEDLVLEN_bm			0x02
+#define PMIC_LOLVLEN_bm				0x01
+#define PMIC_RREN_bm				0x80
+#define PMIC_IVSEL_bm				0x40
+#define RST_SWRST_bm				0x01
+#define CCP_IOREG_gc				0xD8
+
+#endif // sim_avr_io_h
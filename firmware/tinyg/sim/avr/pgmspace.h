@@ -0,0 +1,65 @@
+/*
+ * avr/pgmspace.h - host simulation stand-in for program memory access
+ * Part of TinyG project
+ *
+ * Copyright (c) 2013 Alden S. Hart Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * On the host there is only one address space, so PROGMEM is ordinary const data
+ * and the _P functions collapse onto their libc equivalents.
+ *
+ * The pgm_read_xxx() accessors dereference the pointer with its own type. This matters
+ * for the cfgArray function pointers in config.c - on the xmega they fit in a word, on
+ * a 64 bit host they do not, so a real 16 bit read would truncate them.
+ *
+ * The printf family is routed through sim.c so the avr-libc "%S" conversion (string
+ * in program memory) can be rewritten to "%s" before glibc sees it.
+ */
+#ifndef sim_avr_pgmspace_h
+#define sim_avr_pgmspace_h
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include "io.h"						// avr-libc pgmspace.h pulls this in too
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+
+typedef char prog_char;
+
+#define pgm_read_byte(addr) (*(const uint8_t *)(uintptr_t)(addr))
+#define pgm_read_word(addr) (*(addr))
+#define pgm_read_dword(addr) (*(addr))
+#define pgm_read_float(addr) (*(const float *)(addr))
+
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strlen_P strlen
+#define memcpy_P memcpy
+
+int sim_printf_P(const char *format, ...);
+int sim_fprintf_P(FILE *stream, const char *format, ...);
+int sim_sprintf_P(char *str, const char *format, ...);
+
+#define printf_P sim_printf_P
+#define fprintf_P sim_fprintf_P
+#define sprintf_P sim_sprintf_P
+
+#endif // sim_avr_pgmspace_h
@@ -0,0 +1,20 @@
+/*
+ * avr/sleep.h - host simulation stand-in for sleep modes
+ * Part of TinyG project
+ *
+ * Copyright (c) 2013 Alden S. Hart Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef sim_avr_sleep_h
+#define sim_avr_sleep_h
+
+#define SLEEP_SMODE_IDLE_gc 0x00
+#define SLEEP_SEN_bm 0x01
+#define sleep_mode()
+#define sleep_cpu()
+
+#endif // sim_avr_sleep_h
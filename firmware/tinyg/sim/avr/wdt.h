@@ -0,0 +1,26 @@
+/*
+ * avr/wdt.h - host simulation stand-in for the watchdog timer
+ * Part of TinyG project
+ *
+ * Copyright (c) 2013 Alden S. Hart Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ * tg_reset() enables the watchdog and spins until it bites. In the simulator
+ * enabling the watchdog ends the process instead.
+ */
+#ifndef sim_avr_wdt_h
+#define sim_avr_wdt_h
+
+#define WDTO_15MS 0
+
+void sim_wdt_enable(uint8_t timeout);
+#define wdt_enable(t) sim_wdt_enable(t)
+#define wdt_reset()
+#define wdt_disable()
+
+#endif // sim_avr_wdt_h
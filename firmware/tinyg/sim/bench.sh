@@ -0,0 +1,32 @@
+#!/bin/sh
+#
+# bench.sh - run tinyg_bench over the G-code corpus and print one row per file
+# Part of TinyG project
+#
+# Usage: bench.sh [file ...]
+#	With no arguments runs every file in gcode_samples/ and every PROGMEM program
+#	in firmware/tinyg/gcode/*.h (see corpus.sh).
+#
+# Environment: BENCH (default ./tinyg_bench), SAMPLES, PGM_DIR, CC,
+#	BENCH_TIMEOUT (simulated seconds per file, default 36000)
+
+BENCH=${BENCH:-./tinyg_bench}
+BENCH_TIMEOUT=${BENCH_TIMEOUT:-36000}
+. "$(dirname "$0")/corpus.sh"
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+run() {
+	$BENCH -q -b -T "$BENCH_TIMEOUT" "$1" || echo "$1: tinyg_bench failed ($?)"
+}
+
+$BENCH -H
+if [ $# -gt 0 ]; then
+	for f in "$@"; do run "$f"; done
+	exit 0
+fi
+corpus_files "$tmp" > "$tmp/files"
+while IFS= read -r f; do
+	run "$f" < /dev/null
+done < "$tmp/files"
@@ -0,0 +1,37 @@
+# corpus.sh - G-code corpus for bench.sh and equiv.sh (source it, don't run it)
+# Part of TinyG project
+#
+# corpus_files <tmpdir> prints one path per line: every file in $SAMPLES and
+# every PROGMEM program in $PGM_DIR/*.h. The PROGMEM strings are pulled out by
+# compiling the header on the host, so comments and continuation lines are
+# handled by cpp. Extracted programs are written to <tmpdir>.
+
+SAMPLES=${SAMPLES:-../../../gcode_samples}
+PGM_DIR=${PGM_DIR:-../gcode}
+CC=${CC:-gcc}
+
+# pgm_extract <header> <tmpdir> - write each PROGMEM string in the header to <tmpdir>/<header>[_name].gcode
+pgm_extract() {
+	base=$(basename "$1" .h)
+	names=$($CC -E -P -DPROGMEM= "$1" 2>/dev/null | grep -o 'char [A-Za-z0-9_]*\[\]' | sed 's/char //; s/\[\]//')
+	count=$(echo $names | wc -w)
+	for name in $names; do
+		out="$2/$base.gcode"
+		[ "$count" -gt 1 ] && out="$2/${base}_$name.gcode"
+		printf '#include <stdio.h>\n#define PROGMEM\n#include "%s"\nint main(void) { fputs(%s, stdout); return 0; }\n' \
+			"$(cd "$(dirname "$1")" && pwd)/$(basename "$1")" "$name" > "$2/extract.c"
+		$CC -w -o "$2/extract" "$2/extract.c" && "$2/extract" > "$out"
+	done
+}
+
+corpus_files() {
+	for f in "$SAMPLES"/*; do
+		[ -f "$f" ] && echo "$f"
+	done
+	for h in "$PGM_DIR"/*.h; do
+		pgm_extract "$h" "$1"
+	done
+	for f in "$1"/*.gcode; do
+		[ -f "$f" ] && echo "$f"
+	done
+}
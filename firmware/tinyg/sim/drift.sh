@@ -0,0 +1,61 @@
+#!/bin/sh
+#
+# drift.sh - run tinyg_bench over a long synthetic job and report segment drift
+# Part of TinyG project
+#
+# Usage: drift.sh [moves]
+#	   drift.sh arcs [moves]
+#	Writes a job of <moves> G1 lines (default 2000) and runs it through
+#	tinyg_bench, which checks every aline segment against the exact constant-jerk
+#	curve (see sim_bench.c). The moves zig-zag in 3D well away from the origin, so
+#	positions carry few fractional bits, and alternate long slow runs (long bodies,
+#	thousands of segments) with short fast ones (heads and tails that meet). The
+#	default runs about 3 million segments.
+#
+#	With "arcs" the job is G2/G3 arcs instead (default 400): small holes, pockets,
+#	big sweeps and helixes, each starting where the last ended. Segments are checked
+#	against the exact helix as well as the curve along it.
+#
+# Environment: BENCH (default ./tinyg_bench), DRIFT_TIMEOUT (simulated seconds,
+#	default 360000)
+
+BENCH=${BENCH:-./tinyg_bench}
+DRIFT_TIMEOUT=${DRIFT_TIMEOUT:-360000}
+JOB=lines
+if [ "$1" = "arcs" ]; then JOB=arcs; shift; fi
+MOVES=${1:-2000}
+if [ "$JOB" = "arcs" ]; then MOVES=${1:-400}; fi
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+awk -v moves="$MOVES" -v job="$JOB" 'BEGIN {
+	print "G21 G90 G61"
+	print "G0 X300 Y300 Z50"
+	srand(473)
+	if (job == "arcs") {
+		x = 300; y = 300; z = 50
+		for (i = 0; i < moves; i++) {
+			k = i % 4			# small holes, pockets, big sweeps, helixes
+			r = (k == 0) ? 0.5 + rand() : (k == 1) ? 5 + 20 * rand() : (k == 2) ? 50 + 450 * rand() : 2 + 10 * rand()
+			a = (k == 2) ? 0.2 + rand() : 1 + 5 * rand()		# radians of travel
+			s = 2 * 3.14159265 * rand()							# center direction from the start
+			ci = r * sin(s); cj = r * cos(s)
+			t = atan2(-ci, -cj) + ((i % 2 == 0) ? a : -a)			# end angle from +Y, + is CW (G2)
+			x += ci + r * sin(t); y += cj + r * cos(t)
+			if (k == 3) { z += 10 * rand() - 5; if (z < 0) { z = 0 }; if (z > 100) { z = 100 } }
+			printf "G%d X%.4f Y%.4f Z%.4f I%.4f J%.4f F%.1f\n", (i % 2 == 0) ? 2 : 3, x, y, z, ci, cj, 200 + 2800 * rand()
+		}
+		exit
+	}
+	for (i = 0; i < moves; i++) {
+		if (i % 2 == 0) {
+			x = 200 + 200 * rand(); y = 200 + 200 * rand(); f = 100 + 400 * rand()
+		} else {
+			x += 5 * rand(); y -= 5 * rand(); f = 1000 + 2000 * rand()
+		}
+		printf "G1 X%.4f Y%.4f Z%.4f F%.1f\n", x, y, 40 + 20 * rand(), f
+	}
+}' > "$tmp/drift.gcode"
+
+$BENCH -q -T "$DRIFT_TIMEOUT" "$tmp/drift.gcode" | grep -E "simulated time|segments executed|segment drift|skipped travel|step error"
@@ -0,0 +1,63 @@
+#!/bin/sh
+#
+# equiv.sh - check the simulator build against a reference build
+# Part of TinyG project
+#
+# Usage: REF=<sim> equiv.sh [file ...]
+#	Runs tinyg_sim and the reference build (e.g. tinyg_sim built from another commit)
+#	over the G-code corpus (see corpus.sh) and compares the runs. A file passes if the
+#	simulated times agree to within TIME_TOL percent and every motor ends within
+#	STEP_TOL + STEP_WALK*sqrt(segments) + the reference build's own step error steps
+#	of the reference build. The second term allows for the step rounding that
+#	random-walks from segment to segment. The third allows for the DDA phase that is
+#	carried across segments: on files with many reversals (DXF473) a build can end far
+#	from its machine position and the count is chaotic. Exits non-zero if any file fails.
+#
+# Environment: REF (required), SIM (default ./tinyg_sim),
+#	TIME_TOL (default 0.5), STEP_TOL (default 4), STEP_WALK (default 0.2),
+#	SAMPLES, PGM_DIR, CC, EQUIV_TIMEOUT (simulated seconds per file, default 36000)
+
+SIM=${SIM:-./tinyg_sim}
+REF=${REF:?"set REF to the reference tinyg_sim"}
+TIME_TOL=${TIME_TOL:-0.5}
+STEP_TOL=${STEP_TOL:-4}
+STEP_WALK=${STEP_WALK:-0.2}
+EQUIV_TIMEOUT=${EQUIV_TIMEOUT:-36000}
+. "$(dirname "$0")/corpus.sh"
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+failed=0
+
+# summary <sim> <file> - print "<simulated seconds> <motor steps...> <segments> <max step error>"
+summary() {
+	$1 -q -T "$EQUIV_TIMEOUT" "$2" | awk '
+		/simulated time/ { t = $3 }
+		/segments executed/ { n = $3 }
+		/motor steps/ { s = $3 " " $4 " " $5 " " $6 }
+		/step error/ { for (i = 3; i <= 6; i++) { d = ($i < 0) ? -$i : $i; if (d > e) e = d } }
+		END { print t, s, n, e + 0 }'
+}
+
+compare() {
+	a=$(summary "$REF" "$1")
+	b=$(summary "$SIM" "$1")
+	echo "$a $b" | awk -v name="$(basename "$1")" -v ttol="$TIME_TOL" -v stol="$STEP_TOL" -v walk="$STEP_WALK" '{
+		dt = ($1 > 0) ? 100 * ($8 - $1) / $1 : 0
+		ds = 0
+		for (i = 2; i <= 5; i++) { d = $(i+7) - $i; if (d < 0) d = -d; if (d > ds) ds = d }
+		tol = stol + walk * sqrt($6) + $7
+		ok = ((dt <= ttol) && (dt >= -ttol) && (ds <= tol))
+		printf "%-40s %10.3f %10.3f %8.3f %6d %6d  %s\n", name, $1, $8, dt, ds, tol, ok ? "ok" : "FAIL"
+		exit (ok ? 0 : 1)
+	}' || failed=1
+}
+
+printf "%-40s %10s %10s %8s %6s %6s\n" "file" "ref_s" "sim_s" "dt_%" "steps" "tol"
+if [ $# -gt 0 ]; then
+	for f in "$@"; do compare "$f"; done
+else
+	corpus_files "$tmp" > "$tmp/files"
+	while IFS= read -r f; do compare "$f" < /dev/null; done < "$tmp/files"
+fi
+exit $failed
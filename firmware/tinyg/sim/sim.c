@@ -0,0 +1,423 @@
+/*
+ * sim.c - virtual clock, register file and libc glue for the host simulator
+ * Part of TinyG project
+ *
+ * Copyright (c) 2013 Alden S. Hart Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/* See sim.h for the timer model */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
+#include <string.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+
+#include "../tinyg.h"
+#include "../system.h"
+#include "../config.h"
+#include "../canonical_machine.h"
+#include "../controller.h"
+#include "../planner.h"
+#include "../stepper.h"
+#include "../xmega/xmega_rtc.h"
+#include "../xmega/xmega_eeprom.h"
+#include "../xio/xio.h"
+#include "sim.h"
+
+simSingleton_t sim;
+
+/**** Register file (see sim/avr/io.h) ****/
+
+PORT_t PORTA, PORTB, PORTC, PORTD, PORTE, PORTF;
+VPORT_t VPORT0, VPORT1, VPORT2, VPORT3;
+PORTCFG_t PORTCFG;
+TC0_t TCC0, TCD0, TCE0, TCF0;
+TC1_t TCC1, TCD1, TCE1;
+USART_t USARTC0, USARTC1;
+SPI_t SPIC, SPID;
+RTC_t RTC;
+OSC_t OSC;
+CLK_t CLK;
+PMIC_t PMIC;
+RST_t RST;
+SLEEP_t SLEEP;
+WDT_t WDT;
+NVM_t NVM;
+register8_t CCP;
+register8_t SREG;
+
+/**** Interrupt vectors driven by the virtual clock ****/
+
+void TIMER_DDA_ISR_vect(void);
+void TIMER_DWELL_ISR_vect(void);
+void TIMER_LOAD_ISR_vect(void);
+void TIMER_EXEC_ISR_vect(void);
+void RTC_COMP_vect(void);
+
+typedef struct simTimer {
+	TC0_t *tc;
+	void (*isr)(void);
+	uint32_t *count;
+} simTimer_t;
+
+#define SIM_TIMERS 4
+static const simTimer_t timers[SIM_TIMERS] = {	// in priority order
+	{ &TIMER_DDA,	TIMER_DDA_ISR_vect,		&sim.isr_dda },
+	{ &TIMER_DWELL,	TIMER_DWELL_ISR_vect,	&sim.isr_dwell },
+	{ &TIMER_LOAD,	TIMER_LOAD_ISR_vect,	&sim.isr_load },
+	{ &TIMER_EXEC,	TIMER_EXEC_ISR_vect,	&sim.isr_exec }
+};
+
+#define RTC_CYCLES ((uint64_t)F_CPU / 1000 * RTC_MILLISECONDS)
+
+static void _trace_segment(void);
+static void _run_feedholds(void);
+
+/*
+ * sim_init() - reset the virtual machine
+ *
+ *	Called before sys_init(). The oscillator status reads as ready so the busy-waits
+ *	in rtc_init() fall straight through.
+ */
+void sim_init()
+{
+	memset(&sim, 0, sizeof(sim));
+	sim.loop_cycles = SIM_LOOP_CYCLES_DEFAULT;
+	sim.timeout_cycles = (uint64_t)F_CPU * SIM_TIMEOUT_SECONDS_DEFAULT;
+	sim.resume_cycles = (uint64_t)(F_CPU * SIM_RESUME_SECONDS_DEFAULT);
+	sim.rtc_cycles = RTC_CYCLES;
+	sim.report = stdout;
+	OSC.STATUS = 0xFF;
+}
+
+double sim_seconds() { return ((double)sim.cycles / F_CPU);}
+
+/*
+ * sim_advance() - run the virtual clock forward by the given number of cycles
+ *
+ *	Jumps from one interrupt to the next rather than ticking every cycle. A timer
+ *	overflows PER - CNT + 1 cycles after the current cycle, the same as the xmega
+ *	in normal (count up to TOP) mode.
+ *
+ *	With -e the exec interrupt is held off for lo_holdoff_cycles after each RTC 
+ *	tick, standing in for serial RX and RTC callbacks that keep the LO level busy. 
+ *	A held off exec stays pending (its counter stops) and fires when the time is up.
+ */
+void sim_advance(uint64_t cycles)
+{
+	uint64_t end = sim.cycles + cycles;
+	uint32_t due[SIM_TIMERS];
+	uint8_t held[SIM_TIMERS];
+
+	while (sim.cycles < end) {
+		uint64_t step = end - sim.cycles;
+		uint64_t lo_free = sim.rtc_cycles - RTC_CYCLES + sim.lo_holdoff_cycles;	// end of this tick's hold-off
+
+		for (uint8_t i=0; i<SIM_TIMERS; i++) {
+			TC0_t *tc = timers[i].tc;
+			due[i] = 0;
+			held[i] = false;
+			if (tc->CTRLA == STEP_TIMER_DISABLE) continue;
+			if (tc->CNT <= tc->PER) {
+				due[i] = (uint32_t)tc->PER - tc->CNT + 1;
+			} else {
+				due[i] = 0x10000 - tc->CNT + tc->PER + 1;	// wraps the 16 bit counter first
+			}
+			if ((tc == &TIMER_EXEC) && (sim.cycles + due[i] < lo_free)) {
+				due[i] = lo_free - sim.cycles;
+				held[i] = true;
+			}
+			if (due[i] < step) { step = due[i];}
+		}
+		if ((RTC.INTCTRL != 0) && (sim.rtc_cycles - sim.cycles < step)) {
+			step = sim.rtc_cycles - sim.cycles;
+		}
+
+		// account for stepper starvation while a cycle is running
+		if ((cm.cycle_state != CYCLE_OFF) && (cm.motion_state == MOTION_RUN) &&
+			(TIMER_DDA.CTRLA == STEP_TIMER_DISABLE) && (TIMER_DWELL.CTRLA == STEP_TIMER_DISABLE)) {
+			sim.starved_cycles += step;
+		}
+		sim.cycles += step;
+
+		// advance the counters, then run whatever overflowed - highest priority first
+		for (uint8_t i=0; i<SIM_TIMERS; i++) {
+			if ((due[i] == 0) || (held[i] == true)) continue;
+			timers[i].tc->CNT += (uint16_t)step;
+		}
+		for (uint8_t i=0; i<SIM_TIMERS; i++) {
+			if ((due[i] != step) || (timers[i].tc->CTRLA == STEP_TIMER_DISABLE)) continue;
+			timers[i].tc->CNT = 0;
+			(*timers[i].count)++;
+			timers[i].isr();
+			if (timers[i].tc == &TIMER_EXEC) { _trace_segment();}
+		}
+		if (sim.cycles >= sim.rtc_cycles) {
+			sim.rtc_cycles += RTC_CYCLES;
+			if (RTC.INTCTRL != 0) {
+				sim.isr_rtc++;
+				RTC_COMP_vect();
+			}
+		}
+	}
+}
+
+/*
+ * sim_is_idle() - return TRUE if there is no input left and nothing is queued or moving
+ */
+uint8_t sim_is_idle()
+{
+	if (sim.input_eof == false) return (false);
+	if (tg.primary_src != tg.default_src) return (false);	// still reading a PGM file
+	if (mp_isbusy() == true) return (false);
+	if (mp_get_planner_buffers_available() < PLANNER_BUFFER_POOL_SIZE) return (false);
+	for (uint8_t i=0; i<SIM_TIMERS; i++) {
+		if (timers[i].tc->CTRLA != STEP_TIMER_DISABLE) return (false);
+	}
+	return (true);
+}
+
+/*
+ * sim_controller_callback() - charge one main loop pass and run interrupts that came due
+ *
+ *	Returns STAT_COMPLETE to end tg_controller() once the input is drained and the
+ *	machine is idle, or when the simulated time limit is reached.
+ */
+stat_t sim_controller_callback()
+{
+	sim.loop_passes++;
+	sim_advance(sim.loop_cycles);
+	if (sim.hold_period_cycles != 0) {
+		_run_feedholds();
+	}
+	if (sim_is_idle() == true) {
+		sim.done = true;
+	} else if (sim.cycles >= sim.timeout_cycles) {
+		sim.timed_out = true;
+		sim.done = true;
+	}
+	return ((sim.done == true) ? STAT_COMPLETE : STAT_OK);
+}
+
+/*
+ * sim_step() - count a step pulse (called from the DDA ISR via SIM_STEP())
+ *
+ *	The direction bit is the sign of the move XOR'd with the motor polarity
+ *	(see st_prep_line()), so undo the polarity to get the sign back.
+ */
+void sim_step(const uint8_t motor)
+{
+	static VPORT_t *const vport[SIM_MOTORS] = {
+		&PORT_MOTOR_1_VPORT, &PORT_MOTOR_2_VPORT, &PORT_MOTOR_3_VPORT, &PORT_MOTOR_4_VPORT };
+
+	if ((((vport[motor]->OUT & DIRECTION_BIT_bm) ? 1 : 0) ^ cfg.m[motor].polarity) == 0) {
+		sim.steps[motor]++;
+	} else {
+		sim.steps[motor]--;
+	}
+}
+
+/*
+ * _run_feedholds() - request feedholds and cycle starts for -f and measure the holds
+ *
+ *	A feedhold is requested ('!') hold_period_cycles into each run of motion and 
+ *	a cycle start ('~') resume_cycles after the machine has stopped. Requests are
+ *	made between main loop passes, as the serial RX interrupt would make them.
+ *
+ *	Latency is measured from the request to when the loader starts the first 
+ *	segment prepped after the hold was planned - the first decelerating segment 
+ *	the motors see (see sim_prep() and sim_load()). The hold is over when the hold
+ *	state is HOLD and the DDA has stopped. Travel is measured from motor steps.
+ *	A hold ended some other way (e.g. the program ended under it) is not counted.
+ *	The resume is timed from the cycle start to when the loader starts the first 
+ *	segment after it, and the next feedhold is timed from there.
+ */
+static void _run_feedholds()
+{
+	if (sim.hold_phase == SIM_HOLD_OFF) {
+		if ((sim.cycles < sim.hold_next_cycles) || (cm.motion_state != MOTION_RUN) || 
+			(cm.hold_state != FEEDHOLD_OFF)) {
+			return;
+		}
+		cm_request_feedhold();
+		sim.holds++;
+		sim.hold_request_cycles = sim.cycles;
+		sim.hold_segment = 0;
+		memcpy(sim.hold_steps, sim.steps, sizeof(sim.steps));
+		sim.hold_phase = SIM_HOLD_DECEL;
+		return;
+	}
+	if (sim.hold_phase == SIM_HOLD_RESUME) { return;}	// see sim_load()
+	if (cm.hold_state == FEEDHOLD_OFF) {			// hold was ended under us
+		sim.hold_phase = SIM_HOLD_OFF;
+		sim.hold_next_cycles = sim.cycles + sim.hold_period_cycles;
+		return;
+	}
+	if (sim.hold_phase == SIM_HOLD_DECEL) {
+		if ((cm.hold_state != FEEDHOLD_HOLD) || (TIMER_DDA.CTRLA != STEP_TIMER_DISABLE)) { return;}
+		uint64_t stop = sim.cycles - sim.hold_request_cycles;
+		double travel = 0;
+		uint8_t axes = 0;
+		for (uint8_t i=0; i<SIM_MOTORS; i++) {		// one motor per axis (ganged motors move together)
+			uint8_t axis = cfg.m[i].motor_map;
+			if ((axes & (1<<axis)) != 0) { continue;}
+			axes |= (1<<axis);
+			double distance = (sim.steps[i] - sim.hold_steps[i]) / cfg.m[i].steps_per_unit;
+			travel += distance * distance;
+		}
+		sim.holds_stopped++;
+		sim.hold_stop_cycles += stop;
+		if (stop > sim.hold_stop_max_cycles) { sim.hold_stop_max_cycles = stop;}
+		if (sqrt(travel) > sim.hold_travel_max) { sim.hold_travel_max = sqrt(travel);}
+		sim.resume_at_cycles = sim.cycles + sim.resume_cycles;
+		sim.hold_phase = SIM_HOLD_STOPPED;
+		return;
+	}
+	if (sim.cycles >= sim.resume_at_cycles) {
+		cm_request_cycle_start();
+		sim.resume_at_cycles = sim.cycles;
+		sim.hold_phase = SIM_HOLD_RESUME;
+	}
+}
+
+/*
+ * sim_prep() - count an aline segment prepped for the loader (SIM_PREP())
+ * sim_load() - count an aline segment started by the loader (SIM_LOAD())
+ *
+ *	The prep ring is first in first out, so the segment a count was taken at
+ *	in sim_prep() is the one started when sim_load() reaches the same count.
+ */
+void sim_prep()
+{
+	sim.segments_prepped++;
+	if ((sim.hold_phase == SIM_HOLD_DECEL) && (sim.hold_segment == 0) && (cm.hold_state == FEEDHOLD_DECEL)) {
+		sim.hold_segment = sim.segments_prepped;
+	}
+}
+
+void sim_load()
+{
+	sim.segments_loaded++;
+	if ((sim.hold_phase == SIM_HOLD_DECEL) && (sim.segments_loaded == sim.hold_segment)) {
+		uint64_t latency = sim.cycles - sim.hold_request_cycles;
+		sim.holds_decelerated++;
+		sim.hold_latency_cycles += latency;
+		if (latency > sim.hold_latency_max_cycles) { sim.hold_latency_max_cycles = latency;}
+	}
+	if (sim.hold_phase == SIM_HOLD_RESUME) {
+		uint64_t latency = sim.cycles - sim.resume_at_cycles;
+		sim.resumes++;
+		sim.resume_latency_cycles += latency;
+		if (latency > sim.resume_latency_max_cycles) { sim.resume_latency_max_cycles = latency;}
+		sim.hold_phase = SIM_HOLD_OFF;
+		sim.hold_next_cycles = sim.cycles + sim.hold_period_cycles;
+	}
+}
+
+/*
+ * _trace_segment() - write one CSV line per executed segment if tracing is enabled
+ */
+static void _trace_segment()
+{
+	if ((sim.trace == NULL) || (mp_get_runtime_motion_mode() == MOTION_MODE_CANCEL_MOTION_MODE)) return;
+	fprintf(sim.trace, "%1.6f,%1.0f,%1.3f", sim_seconds(), mp_get_runtime_linenum(), mp_get_runtime_velocity());
+	for (uint8_t i=0; i<AXES; i++) {
+		fprintf(sim.trace, ",%1.4f", mp_get_runtime_machine_position(i));
+	}
+	fprintf(sim.trace, "\n");
+}
+
+/**** xmega support functions replaced for the host ****/
+
+void xmega_init(void) {}
+void CCPWrite(volatile uint8_t *address, uint8_t value) { *address = value;}
+
+void sim_wdt_enable(uint8_t timeout)		// the firmware resets via the watchdog
+{
+	fprintf(sim.report, "tinyg_sim: watchdog reset requested at %1.3f s - exiting\n", sim_seconds());
+	exit(1);
+}
+
+/*
+ * EEPROM emulation - a RAM array, as with __NNVM in xmega_eeprom.c.
+ * Starts out blank so cfg_init() loads the compiled-in defaults.
+ */
+#define SIM_NVM_SIZE 4096					// xmega192/256 EEPROM size
+static char nvm_array[SIM_NVM_SIZE];
+
+uint16_t EEPROM_ReadBytes(const uint16_t address, int8_t *buf, const uint16_t size)
+{
+	memcpy(buf, &nvm_array[address], size);
+	return (address + size);
+}
+
+uint16_t EEPROM_WriteBytes(const uint16_t address, const int8_t *buf, const uint16_t size)
+{
+	memcpy(&nvm_array[address], buf, size);
+	return (address + size);
+}
+
+/*
+ * printf_P family - avr-libc uses %S for strings in program memory.
+ * glibc reads %S as a wide string, so rewrite it to %s first.
+ */
+#define SIM_FORMAT_LEN 256
+
+static const char *_fix_format(const char *format, char *buf)
+{
+	char *out = buf;
+	while ((*format != NUL) && (out < buf + SIM_FORMAT_LEN - 1)) {
+		if ((*out++ = *format++) != '%') continue;
+		while ((*format != NUL) && (strchr("-+ #0123456789.lhjzt", *format) != NULL) &&
+			   (out < buf + SIM_FORMAT_LEN - 1)) {
+			*out++ = *format++;
+		}
+		if (*format == 'S') { *out++ = 's'; format++; }
+	}
+	*out = NUL;
+	return (buf);
+}
+
+int sim_printf_P(const char *format, ...)
+{
+	char buf[SIM_FORMAT_LEN];
+	va_list args;
+	va_start(args, format);
+	int count = vprintf(_fix_format(format, buf), args);
+	va_end(args);
+	return (count);
+}
+
+int sim_fprintf_P(FILE *stream, const char *format, ...)
+{
+	char buf[SIM_FORMAT_LEN];
+	va_list args;
+	va_start(args, format);
+	int count = vfprintf(stream, _fix_format(format, buf), args);
+	va_end(args);
+	return (count);
+}
+
+int sim_sprintf_P(char *str, const char *format, ...)
+{
+	char buf[SIM_FORMAT_LEN];
+	va_list args;
+	va_start(args, format);
+	int count = vsprintf(str, _fix_format(format, buf), args);
+	va_end(args);
+	return (count);
+}
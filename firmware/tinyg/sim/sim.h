@@ -0,0 +1,120 @@
+/*
+ * sim.h - host-native simulator for the TinyG firmware
+ * Part of TinyG project
+ *
+ * Copyright (c) 2013 Alden S. Hart Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * The simulator links the unmodified planner, canonical machine, parsers and stepper
+ * code against memory-backed registers (sim/avr/io.h) and drives them from a virtual
+ * clock that counts F_CPU cycles. Time only advances when the main loop hands control
+ * back (sim_controller_callback()), so a run is deterministic and is limited only by
+ * host speed. See sim/Makefile and sim_main.c for usage.
+ *
+ * Timer model:
+ *	- A timer is running when its CTRLA is non-zero. It counts CNT up to PER at F_CPU,
+ *	  then overflows, resets CNT and calls its ISR. Prescalers are ignored.
+ *	- When several interrupts are due on the same cycle HI level vectors run first
+ *	  (DDA, dwell, load), then LO level (exec, RTC), as on the xmega PMIC.
+ *	- ISRs run to completion - there is no nesting. This is stricter than the hardware
+ *	  where a HI interrupt can preempt the LO level exec, but the firmware already
+ *	  has to tolerate either ordering.
+ */
+#ifndef sim_h
+#define sim_h
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SIM_MOTORS 4							// must agree with MOTORS in tinyg.h
+#define SIM_LOOP_CYCLES_DEFAULT 640				// virtual cycles charged per main loop pass
+#define SIM_TIMEOUT_SECONDS_DEFAULT 36000		// give up after this much simulated time
+#define SIM_RESUME_SECONDS_DEFAULT 0.1			// cycle start this long after a feedhold stops (-f)
+
+enum simHoldPhase {								// feedhold being measured (-f)
+	SIM_HOLD_OFF = 0,							// none - the next is requested at hold_next_cycles
+	SIM_HOLD_DECEL,								// requested, the machine is still moving
+	SIM_HOLD_STOPPED,							// stopped - cycle start at resume_at_cycles
+	SIM_HOLD_RESUME								// cycle started, waiting for the first segment
+};
+
+typedef struct simSingleton {
+	// virtual clock
+	uint64_t cycles;							// F_CPU cycles since reset
+	uint64_t rtc_cycles;						// cycle count of the next RTC tick
+	uint32_t loop_cycles;						// cycles charged per main loop pass
+	uint32_t lo_holdoff_cycles;					// exec (LO) interrupts held off this long after each RTC tick
+	uint64_t timeout_cycles;					// stop the run at this time
+
+	// run control
+	uint8_t input_eof;							// primary input is exhausted
+	uint8_t done;								// set to end tg_controller()
+	FILE *input;								// G-code source (fed to XIO_DEV_USB)
+	const char *pgm;							// PGM file opened by xio_open(), or NULL
+	uint32_t pgm_offset;						// read offset into the PGM file
+	FILE *trace;								// optional segment trace (CSV), or NULL
+	FILE *report;								// simulator messages (survives -q)
+	uint8_t timed_out;							// run was stopped by timeout_cycles
+
+	// feedhold injection (-f, -r)
+	uint64_t hold_period_cycles;				// request a feedhold this long into each run of motion (0 = never)
+	uint64_t resume_cycles;						// ...and a cycle start this long after it stops
+	uint64_t hold_next_cycles;					// time of the next feedhold request
+	uint64_t hold_request_cycles;				// time of the feedhold request being measured
+	uint64_t resume_at_cycles;					// time of the cycle start (when it was due, then when it was made)
+	uint8_t hold_phase;							// see simHoldPhase
+	uint32_t hold_segment;						// first segment prepped after the hold was planned (0 = none yet)
+	uint32_t segments_prepped;					// aline segments prepped (SIM_PREP())
+	uint32_t segments_loaded;					// ...and started by the loader (SIM_LOAD())
+	int32_t hold_steps[SIM_MOTORS];				// motor steps when the feedhold was requested
+
+	// statistics
+	int32_t steps[SIM_MOTORS];					// signed step counts per motor
+	uint32_t loop_passes;						// main loop (_controller_HSM) passes
+	uint32_t lines_read;						// input lines handed to the controller
+	uint32_t isr_dda;							// ISR call counts
+	uint32_t isr_dwell;
+	uint32_t isr_load;
+	uint32_t isr_exec;
+	uint32_t isr_rtc;
+	uint64_t starved_cycles;					// cycles with a cycle running but no DDA or dwell
+	uint32_t holds;								// feedholds requested
+	uint32_t holds_decelerated;					// ...that reached the steppers with a decelerating segment
+	uint32_t holds_stopped;						// ...that stopped the machine
+	uint64_t hold_latency_cycles;				// request to first decelerating segment (sum and worst)
+	uint64_t hold_latency_max_cycles;
+	uint64_t hold_stop_cycles;					// request to standstill (sum and worst)
+	uint64_t hold_stop_max_cycles;
+	double hold_travel_max;						// worst distance travelled after the request (mm)
+	uint32_t resumes;							// cycle starts that restarted motion
+	uint64_t resume_latency_cycles;				// cycle start to first segment (sum and worst)
+	uint64_t resume_latency_max_cycles;
+} simSingleton_t;
+
+extern simSingleton_t sim;
+
+void sim_init(void);
+void sim_advance(uint64_t cycles);				// run the virtual clock forward
+double sim_seconds(void);						// virtual time in seconds
+uint8_t sim_is_idle(void);						// TRUE if nothing is queued or moving
+stat_t sim_controller_callback(void);			// called by tg_controller() on each pass
+
+#ifdef __PLANNER_STATS							// tinyg_bench only - see sim_bench.c
+void sim_bench_header(FILE *out);
+void sim_bench_report(FILE *out, const char *name, uint8_t brief);
+#endif
+
+#endif // sim_h
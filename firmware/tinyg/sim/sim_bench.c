@@ -0,0 +1,344 @@
+/*
+ * sim_bench.c - planner benchmark instrumentation for tinyg_bench
+ * Part of TinyG project
+ *
+ * Copyright (c) 2013 Alden S. Hart Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * tinyg_bench is tinyg_sim built with __PLANNER_STATS and linked with
+ * --wrap=mp_aline, so every call into the planner from the canonical machine
+ * and the arc generator lands in __wrap_mp_aline() below and is timed on the
+ * host clock. The virtual clock only runs between main loop passes, so no ISR
+ * time is ever charged to mp_aline().
+ *
+ * It is also linked with --wrap=TCF0_OVF_vect (TIMER_EXEC_ISR_vect), which times every exec 
+ * (LO) interrupt the same way. That is the ISR profile: the worst case is what
+ * the prep ring has to cover, and block boundaries are where it is set. The
+ * execs that started a block are also profiled on their own.
+ *
+ * And it is linked with --wrap=st_prep_line, which checks every aline segment
+ * against the exact constant-jerk curve. The runtime works in floats. The check
+ * recomputes, in doubles, how far along its section the segment should end and
+ * measures how far the segment's target is from that point. "Drift" is the worst
+ * case over the run. Section ends are tracked separately because the next section
+ * starts from them. Arc blocks are checked against the exact helix, with the
+ * section's start angle taken from where it starts.
+ *
+ * With -f, mp_plan_hold_callback() is wrapped as well (--wrap=mp_plan_hold_callback)
+ * and the passes that planned a feedhold are timed, and separately the passes that 
+ * replanned the queue behind one. The first is on the path from '!' to the first
+ * decelerating segment; it should depend on the braking distance, not the queue.
+ *
+ * Host times are only useful for comparing planner builds on the same box.
+ * The counters (visits and replans per block, HT' iterations) are machine independent.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <avr/pgmspace.h>
+
+#include "../tinyg.h"
+#include "../util.h"
+#include "../canonical_machine.h"
+#include "../planner.h"
+#include "sim.h"
+
+stat_t __real_mp_aline(const float target[], const float minutes, const float work_offset[], const float min_time);
+
+void __real_TCF0_OVF_vect(void);			// TIMER_EXEC_ISR_vect
+
+stat_t __real_st_prep_line(float steps[], uint8_t motors, float microseconds);
+
+stat_t __real_mp_plan_hold_callback(void);
+
+typedef struct simSamples {
+	uint32_t calls;					// calls timed
+	uint32_t samples_size;			// allocated length of samples
+	float *samples;					// per-call host time in nanoseconds
+	double total_ns;
+} simSamples_t;
+
+static struct simBenchSingleton {
+	simSamples_t aline;				// mp_aline() calls, including rejected moves
+	simSamples_t exec;				// exec (LO) interrupts
+	simSamples_t boundary;			// ...the ones that started an aline block
+	simSamples_t hold;				// mp_plan_hold_callback() passes that planned a feedhold
+	simSamples_t hold_queue;		// ...that replanned the queue behind one
+
+	double section_start[AXES];		// position the running section started from
+	double section_start_theta;		// ...and its angle on the arc (arc blocks)
+	uint8_t block_off_plan;			// running block is absorbing travel (not checked)
+	uint32_t off_plan_blocks;
+	double drift_max;				// worst segment distance from the exact curve (mm)
+	double drift_sum_squares;
+	double drift_end_max;			// ...at the last segment of a section
+	uint32_t drift_segments;		// segments checked
+} bench;
+
+static double _get_ns(const struct timespec *t0, const struct timespec *t1)
+{
+	return ((t1->tv_sec - t0->tv_sec) * 1e9 + (t1->tv_nsec - t0->tv_nsec));
+}
+
+static void _add_sample(simSamples_t *s, float ns)
+{
+	if (s->calls == s->samples_size) {
+		s->samples_size = (s->samples_size == 0) ? 4096 : s->samples_size * 2;
+		if ((s->samples = realloc(s->samples, s->samples_size * sizeof(float))) == NULL) {
+			fprintf(sim.report, "tinyg_bench: out of memory\n");
+			exit(1);
+		}
+	}
+	s->samples[s->calls++] = ns;
+	s->total_ns += ns;
+}
+
+stat_t __wrap_mp_aline(const float target[], const float minutes, const float work_offset[], const float min_time)
+{
+	struct timespec t0, t1;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	stat_t status = __real_mp_aline(target, minutes, work_offset, min_time);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	_add_sample(&bench.aline, _get_ns(&t0, &t1));
+	return (status);
+}
+
+void __wrap_TCF0_OVF_vect(void)
+{
+	struct timespec t0, t1;
+	uint32_t boundaries = mps.boundaries;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	__real_TCF0_OVF_vect();
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	_add_sample(&bench.exec, _get_ns(&t0, &t1));
+	if (mps.boundaries != boundaries) {
+		_add_sample(&bench.boundary, _get_ns(&t0, &t1));
+	}
+}
+
+stat_t __wrap_mp_plan_hold_callback(void)
+{
+	struct timespec t0, t1;
+	uint8_t planning = (cm.hold_state == FEEDHOLD_PLAN);
+	uint8_t replanning = (mm.hold_replan != NULL);
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	stat_t status = __real_mp_plan_hold_callback();
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	if ((planning == true) && (cm.hold_state != FEEDHOLD_PLAN)) {
+		_add_sample(&bench.hold, _get_ns(&t0, &t1));
+	} else if ((replanning == true) && (mm.hold_replan == NULL)) {
+		_add_sample(&bench.hold_queue, _get_ns(&t0, &t1));
+	}
+	return (status);
+}
+
+/*
+ * A block whose predecessor was too short to run (and skipped) absorbs the
+ * skipped travel: it runs from where the runtime is, not from where it was
+ * planned to start, so its sections are stretched to fit (plan_line.c, _exec_aline() 
+ * Note 1). Blocks whose planned length is off the distance to their endpoint 
+ * by more than this (mm, per mm) are counted but not checked.
+ */
+#define DRIFT_PLAN_TOLERANCE 0.0001
+
+/*
+ * _get_exact_distance() - exact distance from the start of the running section
+ *						   to the end of the segment about to be prepped
+ *
+ *	Same curves as the runtime (see the forward difference notes in plan_line.c)
+ *	but evaluated directly, in doubles, from the section's own parameters.
+ */
+static double _get_exact_distance(void)
+{
+	double n = mr.segments;
+	double u = (n - mr.segment_count + 1) / n;			// segment_count is not yet decremented
+	double t = mr.move_time / 2;							// time for each half of a head or tail
+	double vs = (mr.move_state == MOVE_STATE_HEAD) ? mr.entry_velocity : mr.cruise_velocity;
+	double vm = mr.midpoint_velocity;
+	double dv = vm - vs;
+
+	if (mr.move_state == MOVE_STATE_BODY) {
+		return ((double)mr.move_time * mr.cruise_velocity * u);
+	}
+	if (mr.section_state == MOVE_STATE_RUN1) {
+		return (t * (vs*u + dv*u*u*u/3));
+	}
+	return (t * (vs + dv/3) + t * (vm*u + dv*u*u - dv*u*u*u/3));
+}
+
+/*
+ * _get_section_start_theta() - angle on the running arc of the section's start
+ *
+ *	From the start position, unwrapped to the turn of the angle the runtime has 
+ *	reached (the end of the first segment).
+ */
+static double _get_section_start_theta(void)
+{
+	double theta = atan2((double)mr.position[mr.axis_1] - mr.center_1, (double)mr.position[mr.axis_2] - mr.center_2);
+	return (theta + 2*M_PI * floor(((double)mr.theta - theta) / (2*M_PI) + 0.5));
+}
+
+stat_t __wrap_st_prep_line(float steps[], uint8_t motors, float microseconds)
+{
+	if ((mr.section_state == MOVE_STATE_RUN1) || (mr.section_state == MOVE_STATE_RUN2)) {	// RUN1 is RUN
+		if ((mr.section_state != MOVE_STATE_RUN2) && (mr.segment_count == (uint32_t)mr.segments)) {
+			for (uint8_t i=0; i<AXES; i++) { bench.section_start[i] = mr.position[i];}
+			if (mr.move_type == MOVE_TYPE_ARC) {
+				bench.section_start_theta = _get_section_start_theta();
+			}
+			if ((mr.move_state == MOVE_STATE_HEAD) ||		// first section of the block
+				((mr.move_state == MOVE_STATE_BODY) && fp_ZERO(mr.head_length)) ||
+				((mr.move_state == MOVE_STATE_TAIL) && fp_ZERO(mr.head_length) && fp_ZERO(mr.body_length))) {
+				double planned = (double)mr.head_length + mr.body_length + mr.tail_length;
+				double length = 0;
+				if (mr.move_type == MOVE_TYPE_ARC) {		// the path along the helix
+					length = square(((double)mr.endpoint_theta - bench.section_start_theta) / mr.angular_rate);
+				} else {
+					for (uint8_t i=0; i<AXES; i++) {
+						length += square((double)mr.endpoint[i] - mr.position[i]);
+					}
+				}
+				bench.block_off_plan = (fabs(sqrt(length) - planned) > (DRIFT_PLAN_TOLERANCE * (1 + planned)));
+				if (bench.block_off_plan == true) { bench.off_plan_blocks++;}
+			}
+		}
+		if (bench.block_off_plan == true) {
+			return (__real_st_prep_line(steps, motors, microseconds));
+		}
+		double distance = _get_exact_distance();
+		double exact[AXES];
+		double error = 0;
+		for (uint8_t i=0; i<AXES; i++) {
+			exact[i] = bench.section_start[i] + mr.unit[i] * distance;
+		}
+		if (mr.move_type == MOVE_TYPE_ARC) {
+			double theta = bench.section_start_theta + mr.angular_rate * distance;
+			exact[mr.axis_1] = mr.center_1 + sin(theta) * mr.radius;
+			exact[mr.axis_2] = mr.center_2 + cos(theta) * mr.radius;
+		}
+		for (uint8_t i=0; i<AXES; i++) {
+			if ((mr.axes & (1<<i)) == 0) { continue;}
+			error += square(mr.target[i] - exact[i]);
+		}
+		error = sqrt(error);
+		bench.drift_segments++;
+		bench.drift_sum_squares += error * error;
+		bench.drift_max = max(bench.drift_max, error);
+		if (((mr.section_state == MOVE_STATE_RUN2) || (mr.move_state == MOVE_STATE_BODY)) && (mr.segment_count == 1)) {
+			bench.drift_end_max = max(bench.drift_end_max, error);
+		}
+	}
+	return (__real_st_prep_line(steps, motors, microseconds));
+}
+
+static int _compare_float(const void *a, const void *b)
+{
+	float fa = *(const float *)a, fb = *(const float *)b;
+	return ((fa > fb) - (fa < fb));
+}
+
+/*
+ * _get_percentile() - sort the samples and return a percentile in microseconds
+ */
+static double _get_percentile(simSamples_t *s, double percent)
+{
+	if (s->calls == 0) { return (0);}
+	qsort(s->samples, s->calls, sizeof(float), _compare_float);
+	uint32_t i = (uint32_t)(s->calls * percent / 100);
+	if (i >= s->calls) { i = s->calls - 1;}
+	return (s->samples[i] / 1000);
+}
+
+/*
+ * sim_bench_report() - print planner statistics for the run
+ *
+ *	brief == true prints a single table row (see sim_bench_header()) so bench.sh
+ *	can build a table over a whole corpus.
+ */
+void sim_bench_header(FILE *out)
+{
+	fprintf(out, "%-36s %7s %7s %9s %8s %8s %8s %8s %7s %7s %9s %8s %6s %7s %8s %8s\n", "file", "blocks", "merged",
+			"blocks/s", "mean_us", "p99_us", "visits", "replans", "HT'", "HT'itr", "sim_s", "starve_s", "jerk%", "seg/s",
+			"exec_us", "drift_um");
+}
+
+void sim_bench_report(FILE *out, const char *name, uint8_t brief)
+{
+	double mean_us = 0, p99_us = 0;
+	double blocks = (mps.blocks > 0) ? mps.blocks : 1;
+
+	if (bench.aline.calls > 0) {
+		mean_us = bench.aline.total_ns / bench.aline.calls / 1000;
+		p99_us = _get_percentile(&bench.aline, 99);
+	}
+	double exec_mean_us = (bench.exec.calls > 0) ? bench.exec.total_ns / bench.exec.calls / 1000 : 0;
+	double exec_p999_us = _get_percentile(&bench.exec, 99.9);
+	double exec_max_us = _get_percentile(&bench.exec, 100);
+	double boundary_mean_us = (bench.boundary.calls > 0) ? bench.boundary.total_ns / bench.boundary.calls / 1000 : 0;
+	double boundary_p99_us = _get_percentile(&bench.boundary, 99);
+	double preload_rate = (mps.boundaries > 0) ? 100.0 * mps.preloads / mps.boundaries : 0;
+	double blocks_per_sec = (bench.aline.total_ns > 0) ? mps.blocks / (bench.aline.total_ns / 1e9) : 0;
+	double visits = mps.plan_visits / blocks;
+	double replans = mps.plan_replans / blocks;
+	double iterations = (mps.ht_asymmetric > 0) ? (double)mps.ht_iterations / mps.ht_asymmetric : 0;
+	double jerks = mps.jerk_hits + mps.jerk_misses;
+	double jerk_rate = (jerks > 0) ? 100 * mps.jerk_hits / jerks : 0;
+	double segments_per_sec = (sim_seconds() > 0) ? mps.segments / sim_seconds() : 0;	// simulated seconds
+	double drift_rms = (bench.drift_segments > 0) ? sqrt(bench.drift_sum_squares / bench.drift_segments) : 0;
+
+	if (brief == true) {
+		const char *base = strrchr(name, '/');
+		fprintf(out, "%-36s %7lu %7lu %9.0f %8.2f %8.2f %8.2f %8.2f %7lu %7.2f %9.2f %8.3f %6.1f %7.1f %8.2f %8.3f\n",
+				(base != NULL) ? base+1 : name, (unsigned long)mps.blocks, (unsigned long)mps.coalesced, blocks_per_sec,
+				mean_us, p99_us, visits, replans, (unsigned long)mps.ht_asymmetric, iterations,
+				sim_seconds(), (double)sim.starved_cycles / F_CPU, jerk_rate, segments_per_sec,
+				exec_p999_us, bench.drift_max * 1000);
+		return;
+	}
+	fprintf(out, "  planner blocks     %lu (%lu mp_aline calls, %lu arcs, %lu lines coalesced, %lu corners blended)\n",
+			(unsigned long)mps.blocks, (unsigned long)bench.aline.calls, (unsigned long)mps.arcs, (unsigned long)mps.coalesced, 
+			(unsigned long)mps.blended);
+	fprintf(out, "  planner throughput %1.0f blocks/s\n", blocks_per_sec);
+	fprintf(out, "  mp_aline cost      %1.2f us mean, %1.2f us p99\n", mean_us, p99_us);
+	fprintf(out, "  buffers visited    %1.2f per block\n", visits);
+	fprintf(out, "  blocks replanned   %1.2f per block, %lu converged early\n", replans, (unsigned long)mps.plan_converged);
+	fprintf(out, "  trapezoids         %1.2f per block\n", mps.trapezoids / blocks);
+	fprintf(out, "  jerk terms         %1.1f%% from the cache\n", jerk_rate);
+	fprintf(out, "  segments           %lu, %1.1f per simulated second\n", (unsigned long)mps.segments, segments_per_sec);
+	fprintf(out, "  exec ISR cost      %1.2f us mean, %1.2f us p99.9, %1.2f us max (%lu calls)\n",
+			exec_mean_us, exec_p999_us, exec_max_us, (unsigned long)bench.exec.calls);
+	fprintf(out, "  block boundaries   %lu, %1.1f%% preloaded, exec %1.2f us mean, %1.2f us p99\n",
+			(unsigned long)mps.boundaries, preload_rate, boundary_mean_us, boundary_p99_us);
+	fprintf(out, "  segment drift      %1.3f um max, %1.3f um rms, %1.3f um max at section ends (%lu segments)\n",
+			bench.drift_max * 1000, drift_rms * 1000, bench.drift_end_max * 1000, (unsigned long)bench.drift_segments);
+	fprintf(out, "                     %lu blocks absorbing skipped travel not checked\n", 
+			(unsigned long)bench.off_plan_blocks);
+	fprintf(out, "  HT' cases          %lu, %1.2f iterations each\n", (unsigned long)mps.ht_asymmetric, iterations);
+	if (bench.hold.calls > 0) {
+		fprintf(out, "  feedhold planning  %lu holds, %1.2f blocks each, %1.2f us mean, %1.2f us max\n",
+				(unsigned long)mps.holds, (double)mps.hold_blocks / mps.holds, 
+				bench.hold.total_ns / bench.hold.calls / 1000, _get_percentile(&bench.hold, 100));
+		fprintf(out, "  queue replan       %lu after holds, %1.2f blocks each, %1.2f us mean, %1.2f us max\n", 
+				(unsigned long)bench.hold_queue.calls, 
+				(bench.hold_queue.calls > 0) ? (double)mps.hold_queue_blocks / bench.hold_queue.calls : 0,
+				(bench.hold_queue.calls > 0) ? bench.hold_queue.total_ns / bench.hold_queue.calls / 1000 : 0,
+				_get_percentile(&bench.hold_queue, 100));
+	}
+}
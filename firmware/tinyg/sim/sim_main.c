@@ -0,0 +1,201 @@
+/*
+ * sim_main.c - tinyg_sim entry point
+ * Part of TinyG project
+ *
+ * Copyright (c) 2013 Alden S. Hart Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Usage: tinyg_sim [options] [file]
+ *
+ *	Runs a G-code file (or stdin) through the firmware on a virtual clock and prints
+ *	a summary when the machine goes idle. $ and JSON lines in the file are processed
+ *	exactly as if they came in over USB, so a file can carry its own machine settings.
+ *
+ *	-q			quiet: discard the firmware's own output (prompts, status reports, errors)
+ *	-l cycles	F_CPU cycles charged per main loop pass (default SIM_LOOP_CYCLES_DEFAULT)
+ *	-e usec		hold the exec (LO) interrupt off for this long after every RTC tick
+ *	-t file		write a CSV trace of every executed segment:
+ *				seconds, line number, velocity, then machine position for each axis
+ *	-T seconds	stop after this much simulated time (default SIM_TIMEOUT_SECONDS_DEFAULT)
+ *	-f seconds	request a feedhold ('!') this long into each run of motion and report
+ *				how long the holds took to take effect, to stop and to resume (see sim.c)
+ *	-r seconds	cycle start ('~') this long after a feedhold stops (default SIM_RESUME_SECONDS_DEFAULT)
+ *
+ *	tinyg_bench only (see sim_bench.c):
+ *	-b			print the planner statistics as one table row instead of the summary
+ *	-H			print the table header for -b and exit
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+
+#include "../xmega/xmega_interrupts.h"
+#include "../xmega/xmega_rtc.h"
+#include "../xio/xio.h"
+
+#include "../tinyg.h"
+#include "../system.h"
+#include "../util.h"
+#include "../config.h"
+#include "../controller.h"
+#include "../canonical_machine.h"
+#include "../report.h"
+#include "../planner.h"
+#include "../stepper.h"
+#include "../spindle.h"
+#include "../gpio.h"
+#include "../pwm.h"
+#include "sim.h"
+
+stat_t status_code;				// declared in main.c on the xmega
+
+static double _host_seconds(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+static void _usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-q] [-b] [-H] [-l loop_cycles] [-e holdoff_usec] [-t trace.csv] [-T seconds] [-f hold_seconds] [-r resume_seconds] [file]\n", name);
+	exit(2);
+}
+
+static void _print_summary(FILE *out, const char *name, double host_seconds)
+{
+	double seconds = sim_seconds();
+
+	fprintf(out, "tinyg_sim: %s\n", name);
+	fprintf(out, "  lines read         %lu\n", (unsigned long)sim.lines_read);
+	fprintf(out, "  simulated time     %1.3f s%s\n", seconds, (sim.timed_out == true) ? " (timed out)" : "");
+	fprintf(out, "  host time          %1.3f s (%1.0fx real time)\n", host_seconds,
+			(host_seconds > 0) ? seconds / host_seconds : 0);
+	fprintf(out, "  main loop passes   %lu\n", (unsigned long)sim.loop_passes);
+	fprintf(out, "  segments executed  %lu\n", (unsigned long)sim.isr_exec);
+	fprintf(out, "  DDA ticks          %lu\n", (unsigned long)sim.isr_dda);
+	fprintf(out, "  stepper starved    %1.3f s\n", (double)sim.starved_cycles / F_CPU);
+	fprintf(out, "  prep underruns     %lu\n", (unsigned long)st_get_prep_underruns());
+	if (sim.holds > 0) {
+		double ms = 1000.0 / F_CPU;
+		fprintf(out, "  feedholds          %lu, first decelerating segment %1.3f ms mean, %1.3f ms max after '!'\n",
+				(unsigned long)sim.holds, 
+				(sim.holds_decelerated > 0) ? sim.hold_latency_cycles * ms / sim.holds_decelerated : 0,
+				sim.hold_latency_max_cycles * ms);
+		fprintf(out, "                     %lu stopped in %1.3f ms mean, %1.3f ms max, %1.3f mm max travel\n",
+				(unsigned long)sim.holds_stopped, 
+				(sim.holds_stopped > 0) ? sim.hold_stop_cycles * ms / sim.holds_stopped : 0,
+				sim.hold_stop_max_cycles * ms, sim.hold_travel_max);
+		fprintf(out, "                     %lu resumed, first segment %1.3f ms mean, %1.3f ms max after '~'\n",
+				(unsigned long)sim.resumes, 
+				(sim.resumes > 0) ? sim.resume_latency_cycles * ms / sim.resumes : 0,
+				sim.resume_latency_max_cycles * ms);
+	}
+	fprintf(out, "  motor steps       ");
+	for (uint8_t i=0; i<SIM_MOTORS; i++) {
+		fprintf(out, " %ld", (long)sim.steps[i]);
+	}
+	fprintf(out, "\n  machine position  ");
+	for (uint8_t i=0; i<AXES; i++) {
+		fprintf(out, " %1.4f", mp_get_runtime_machine_position(i));
+	}
+	fprintf(out, "\n  step error        ");	// steps the motors are off the machine position
+	for (uint8_t i=0; i<SIM_MOTORS; i++) {
+		float steps = mp_get_runtime_machine_position(cfg.m[i].motor_map) * cfg.m[i].steps_per_unit;
+		fprintf(out, " %1.0f", sim.steps[i] - steps);
+	}
+	fprintf(out, "\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char *name = "stdin";
+	uint8_t quiet = false;
+	uint8_t brief = false;
+	int opt;
+
+	sim_init();
+	sim.input = stdin;
+	while ((opt = getopt(argc, argv, "qbHl:e:t:T:f:r:")) != -1) {
+		switch (opt) {
+			case 'q': { quiet = true; break;}
+#ifdef __PLANNER_STATS
+			case 'b': { brief = true; break;}
+			case 'H': { sim_bench_header(stdout); exit(0);}
+#endif
+			case 'l': { sim.loop_cycles = strtoul(optarg, NULL, 0); break;}
+			case 'e': {
+				sim.lo_holdoff_cycles = strtoul(optarg, NULL, 0) * (F_CPU / 1000000);
+				if (sim.lo_holdoff_cycles >= F_CPU / 1000 * RTC_MILLISECONDS) _usage(argv[0]);	// exec would never run
+				break;
+			}
+			case 'T': { sim.timeout_cycles = (uint64_t)(atof(optarg) * F_CPU); break;}
+			case 'f': { 
+				sim.hold_period_cycles = (uint64_t)(atof(optarg) * F_CPU); 
+				sim.hold_next_cycles = sim.hold_period_cycles;
+				break;
+			}
+			case 'r': { sim.resume_cycles = (uint64_t)(atof(optarg) * F_CPU); break;}
+			case 't': {
+				if ((sim.trace = fopen(optarg, "w")) == NULL) { perror(optarg); exit(1);}
+				break;
+			}
+			default: _usage(argv[0]);
+		}
+	}
+	if (optind < argc) {
+		name = argv[optind];
+		if ((sim.input = fopen(name, "r")) == NULL) { perror(name); exit(1);}
+	}
+	if (quiet == true) {		// firmware writes to both; keep a handle on the real stdout
+		sim.report = fdopen(dup(fileno(stdout)), "w");
+		if ((freopen("/dev/null", "w", stdout) == NULL) || (freopen("/dev/null", "w", stderr) == NULL)) { 
+			perror("/dev/null"); 
+			exit(1);
+		}
+	}
+
+	// same order as main.c. net_init() is left out - there is no RS-485 here
+	sys_init();
+	rtc_init();
+	xio_init();
+	st_init();
+	gpio_init();
+	pwm_init();
+	tg_init(STD_IN, STD_OUT, STD_ERR);
+	cfg_init();
+	mp_init();
+	cm_init();
+	sp_init();
+	PMIC_EnableHighLevel();
+	PMIC_EnableMediumLevel();
+	PMIC_EnableLowLevel();
+	sei();
+	rpt_print_system_ready_message();
+
+	double start = _host_seconds();
+	tg_controller();			// returns when the input is drained and the machine is idle
+	if (brief == false) {
+		_print_summary(sim.report, name, _host_seconds() - start);
+	}
+#ifdef __PLANNER_STATS
+	sim_bench_report(sim.report, name, brief);
+#endif
+	return (0);
+}
@@ -0,0 +1,96 @@
+/*
+ * sim_xio.c - host replacement for the xio device layer
+ * Part of TinyG project
+ *
+ * Copyright (c) 2013 Alden S. Hart Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * The real xio layer is built on avr-libc FILE streams (udata, fdev_setup_stream)
+ * which glibc does not have. This file provides the same public API on top of host
+ * stdio instead:
+ *
+ *	- XIO_DEV_USB reads lines from sim.input (the G-code file given on the command line).
+ *	  End of file is reported as STAT_EAGAIN, like a serial port that has gone quiet.
+ *	- XIO_DEV_PGM reads lines from the string given to xio_open(), so $test=n and
+ *	  the built-in gcode files work. End of file returns STAT_EOF as on the xmega.
+ *	- Output goes to host stdout / stderr. The USB TX queue is always empty.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <avr/pgmspace.h>
+
+#include "../tinyg.h"
+#include "../xio/xio.h"
+#include "sim.h"
+
+void xio_init() {}
+void xio_init_stdio() {}
+void xio_set_stdin(const uint8_t dev) {}
+void xio_set_stdout(const uint8_t dev) {}
+void xio_set_stderr(const uint8_t dev) {}
+void xio_reset_usb_rx_buffers() {}
+
+int xio_ctrl(const uint8_t dev, const flags_t flags) { return (XIO_OK);}
+int xio_set_baud(const uint8_t dev, const uint8_t baud_rate) { return (XIO_OK);}
+uint8_t xio_assertions(uint8_t *value) { return (STAT_OK);}
+buffer_t xio_get_tx_bufcount_usart(const xioUsart_t *dx) { return (0);}
+buffer_t xio_get_usb_rx_free() { return (RX_BUFFER_SIZE);}
+
+FILE *xio_open(const uint8_t dev, const char *addr, const flags_t flags)
+{
+	if (dev == XIO_DEV_PGM) {
+		sim.pgm = addr;
+		sim.pgm_offset = 0;
+	}
+	return (stdin);
+}
+
+/*
+ * xio_gets() - non-blocking line reader. Strips the line terminator like xio_gets_usart()
+ */
+int xio_gets(const uint8_t dev, char *buf, const int size)
+{
+	if (dev == XIO_DEV_PGM) {
+		if (sim.pgm == NULL) return (XIO_FILE_NOT_OPEN);
+		if (sim.pgm[sim.pgm_offset] == NUL) {
+			sim.pgm = NULL;
+			return (XIO_EOF);
+		}
+		int i = 0;
+		char c;
+		while (((c = sim.pgm[sim.pgm_offset]) != NUL) && (i < size-1)) {
+			sim.pgm_offset++;
+			if ((c == '\n') || (c == '\r')) break;
+			buf[i++] = c;
+		}
+		buf[i] = NUL;
+		return (XIO_OK);
+	}
+	if ((sim.input == NULL) || (sim.input_eof == true)) return (XIO_EAGAIN);
+	if (fgets(buf, size, sim.input) == NULL) {
+		sim.input_eof = true;
+		return (XIO_EAGAIN);
+	}
+	buf[strcspn(buf, "\r\n")] = NUL;
+	sim.lines_read++;
+	return (XIO_OK);
+}
+
+int xio_getc(const uint8_t dev) { return (-1);}			// _FDEV_ERR
+
+int xio_putc(const uint8_t dev, const char c)
+{
+	return (putchar(c));
+}
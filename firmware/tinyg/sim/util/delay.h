@@ -0,0 +1,18 @@
+/*
+ * util/delay.h - host simulation stand-in for busy-wait delays
+ * Part of TinyG project
+ *
+ * Copyright (c) 2013 Alden S. Hart Jr.
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef sim_util_delay_h
+#define sim_util_delay_h
+
+#define _delay_us(us)
+#define _delay_ms(ms)
+
+#endif // sim_util_delay_h
@@ -120,7 +120,7 @@ static void _exec_spindle_control(uint8_t spindle_mode, float f)
 stat_t cm_set_spindle_speed(float speed)
 {
 //	if (speed > cfg.max_spindle speed) { return (STAT_MAX_SPINDLE_SPEED_EXCEEDED);}
-	mp_queue_command(_exec_spindle_speed, 0, speed);
+	mp_queue_inline_command(_exec_spindle_speed, 0, speed);
     return (STAT_OK);
 }
 
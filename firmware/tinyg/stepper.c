@@ -177,7 +177,8 @@ static void _request_load_move(void);
  *	data structure:						static to:		runs at:
  *	  mpBuffer planning buffers (bf)	  planner.c		  main loop
  *	  mrRuntimeSingleton (mr)			  planner.c		  MED ISR
- *	  stPrepSingleton (sp)				  stepper.c		  MED ISR
+ *	  mrRuntimeSingleton (ms)			  planner.c		  MED ISR (shadow of mr)
+ *	  stPrepSingleton (sps)				  stepper.c		  MED ISR
  *	  stRunSingleton (st)				  stepper.c		  HI ISR
  *  
  *	Care has been taken to isolate actions on these structures to the 
@@ -213,18 +214,29 @@ typedef struct stPrepMotor {
 	int8_t dir;						// b0 = direction
 } stPrepMotor_t;
 
-typedef struct stPrepSingleton {
-	uint16_t magic_start;			// magic number to test memory integity	
+typedef struct stPrepBuffer {		// one prepared segment in the ring
 	uint8_t move_type;				// move type
 	uint8_t prep_state;				// set TRUE to load, false to skip
 	volatile uint8_t exec_state;	// move execution state 
 	volatile uint8_t reset_flag;	// TRUE if accumulator should be reset
-	uint32_t prev_ticks;			// tick count from previous move
 	uint16_t dda_period;			// DDA or dwell clock period setting
 	uint32_t dda_ticks;				// DDA or dwell ticks for the move
 	uint32_t dda_ticks_X_substeps;	// DDA ticks scaled by substep factor
 //	float segment_velocity;			// +++++ record segment velocity for diagnostics
 	stPrepMotor_t m[MOTORS];		// per-motor structs
+	void (*cm_func)(uint8_t, float);// inline command the loader fires (see st_prep_command())
+	uint8_t int_val;
+	float dbl_val;
+} stPrepBuffer_t;
+
+typedef struct stPrepSingleton {
+	uint16_t magic_start;			// magic number to test memory integity	
+	uint8_t exec_index;				// buffer the exec stage fills next (written by exec only)
+	uint8_t load_index;				// buffer the loader drains next (written by loader only)
+	volatile uint8_t exec_busy;		// TRUE while _exec_move() is running
+	uint32_t prev_ticks;			// tick count from previous move
+	uint32_t underruns;				// loads that found the ring empty while exec was behind
+	stPrepBuffer_t bf[STEP_PREP_RING_SIZE];
 } stPrepSingleton_t;
 
 // Allocate static structures
@@ -233,6 +245,7 @@ static struct stPrepSingleton sps;
 
 uint16_t st_get_st_magic() { return (st.magic_start);}
 uint16_t st_get_sps_magic() { return (sps.magic_start);}
+uint32_t st_get_prep_underruns() { return (sps.underruns);}
 
 /* 
  * st_init() - initialize stepper motor subsystem 
@@ -284,7 +297,9 @@ void st_init()
 	TIMER_EXEC.INTCTRLA = TIMER_EXEC_INTLVL;	// interrupt mode
 	TIMER_EXEC.PER = SWI_PERIOD;				// set period
 
-	sps.exec_state = PREP_BUFFER_OWNED_BY_EXEC;
+	for (uint8_t i=0; i<STEP_PREP_RING_SIZE; i++) {
+		sps.bf[i].exec_state = PREP_BUFFER_OWNED_BY_EXEC;
+	}
 }
 
 /* 
@@ -369,21 +384,25 @@ ISR(TIMER_DDA_ISR_vect)
 		PORT_MOTOR_1_VPORT.OUT |= STEP_BIT_bm;	// turn step bit on
  		st.m[MOTOR_1].phase_accumulator -= st.dda_ticks_X_substeps;
 		PORT_MOTOR_1_VPORT.OUT &= ~STEP_BIT_bm;	// turn step bit off in ~1 uSec
+		SIM_STEP(MOTOR_1);
 	}
 	if ((st.m[MOTOR_2].phase_accumulator += st.m[MOTOR_2].phase_increment) > 0) {
 		PORT_MOTOR_2_VPORT.OUT |= STEP_BIT_bm;
  		st.m[MOTOR_2].phase_accumulator -= st.dda_ticks_X_substeps;
 		PORT_MOTOR_2_VPORT.OUT &= ~STEP_BIT_bm;
+		SIM_STEP(MOTOR_2);
 	}
 	if ((st.m[MOTOR_3].phase_accumulator += st.m[MOTOR_3].phase_increment) > 0) {
 		PORT_MOTOR_3_VPORT.OUT |= STEP_BIT_bm;
  		st.m[MOTOR_3].phase_accumulator -= st.dda_ticks_X_substeps;
 		PORT_MOTOR_3_VPORT.OUT &= ~STEP_BIT_bm;
+		SIM_STEP(MOTOR_3);
 	}
 	if ((st.m[MOTOR_4].phase_accumulator += st.m[MOTOR_4].phase_increment) > 0) {
 		PORT_MOTOR_4_VPORT.OUT |= STEP_BIT_bm;
  		st.m[MOTOR_4].phase_accumulator -= st.dda_ticks_X_substeps;
 		PORT_MOTOR_4_VPORT.OUT &= ~STEP_BIT_bm;
+		SIM_STEP(MOTOR_4);
 	}
 	if (--st.dda_ticks_downcount == 0) {		// end move
  		TIMER_DDA.CTRLA = STEP_TIMER_DISABLE;	// disable DDA timer
@@ -419,15 +438,32 @@ ISR(TIMER_EXEC_ISR_vect) {						// exec move SW interrupt
  * st_test_exec_state()	   - return TRUE if exec/prep can run
  * _request_load_move()    - SW interrupt to request to load a move
  *	st_request_exec_move() - SW interrupt to request to execute a move
+ *	st_request_exec_preload() - SW interrupt to request a spare exec
+ *	st_exec_hold()			   - hold off the exec interrupt
+ *	st_exec_release()		   - let it run again
  * _exec_move() 		   - Run a move from the planner and prepare it for loading
  *
  *	_exec_move() can only be called be called from an ISR at a level lower
  *	than DDA, Only use st_request_exec_move() to call it.
+ *
+ *	The exec stage fills the prep ring at sps.exec_index and the loader drains
+ *	it at sps.load_index. Each side only moves its own index and only touches 
+ *	buffers it owns, so the exec_state byte is the whole handshake. After each 
+ *	segment exec asks for another run until the ring is full. It stops early if 
+ *	the planner has nothing to run (NOOP) or ran without prepping anything 
+ *	(e.g. a dwell in progress) - the loader asks again when it drains a buffer 
+ *	or finds the ring empty. A buffer is only handed to the loader if something
+ *	was prepped into it, so a segment st_prep_line() refused is never replaced 
+ *	by a replay of the previous one.
+ *
+ *	An exec that finds the ring full has no segment to prep. The planner asks 
+ *	for one of these with st_request_exec_preload() when it has work to do off 
+ *	the segment path - loading the next block (see mp_preload_move()).
  */
 
 uint8_t st_test_exec_state()
 {
-	if (sps.exec_state == PREP_BUFFER_OWNED_BY_EXEC) {
+	if (sps.bf[sps.exec_index].exec_state == PREP_BUFFER_OWNED_BY_EXEC) {
 		return (true);
 	}
 	return (false);
@@ -435,20 +471,50 @@ uint8_t st_test_exec_state()
 
 void st_request_exec_move()
 {
-	if (sps.exec_state == PREP_BUFFER_OWNED_BY_EXEC) {	// bother interrupting
+	if (sps.bf[sps.exec_index].exec_state == PREP_BUFFER_OWNED_BY_EXEC) {	// bother interrupting
 		TIMER_EXEC.PER = SWI_PERIOD;
 		TIMER_EXEC.CTRLA = STEP_TIMER_ENABLE;			// trigger a LO interrupt
 	}
 }
 
+void st_request_exec_preload()
+{
+	TIMER_EXEC.PER = SWI_PERIOD;
+	TIMER_EXEC.CTRLA = STEP_TIMER_ENABLE;				// trigger a LO interrupt
+}
+
+/*
+ *	The main loop holds the exec off while it changes planner state the exec 
+ *	also writes and that takes more than one instruction (e.g. a float). Only 
+ *	the exec's interrupt is masked, so serial RX and the RTC still run, and an
+ *	exec requested meanwhile runs on the release as its overflow flag is still set.
+ */
+void st_exec_hold() { TIMER_EXEC.INTCTRLA = 0;}
+void st_exec_release() { TIMER_EXEC.INTCTRLA = TIMER_EXEC_INTLVL;}
+
 static void _exec_move()
 {
-   	if (sps.exec_state == PREP_BUFFER_OWNED_BY_EXEC) {
-//		if (mp_exec_move(state) != STAT_NOOP) {
-		if (mp_exec_move() != STAT_NOOP) {
-			sps.exec_state = PREP_BUFFER_OWNED_BY_LOADER; // flip it back
-			_request_load_move();
+	stPrepBuffer_t *bf = &sps.bf[sps.exec_index];
+
+	if (bf->exec_state == PREP_BUFFER_OWNED_BY_EXEC) {
+		sps.exec_busy = true;
+		stat_t status = mp_exec_move();
+		if ((status != STAT_NOOP) && (bf->prep_state == false)) {
+			status = mp_exec_move();				// ended a block without a segment - try the next one
 		}
+		if (status != STAT_NOOP) {
+			if (bf->prep_state == true) {
+				bf->exec_state = PREP_BUFFER_OWNED_BY_LOADER; // flip it back
+				if (++sps.exec_index == STEP_PREP_RING_SIZE) { sps.exec_index = 0;}
+				_request_load_move();
+				st_request_exec_move();				// keep filling the ring
+			} else if ((st.dda_ticks_downcount == 0) && (st_prep_isbusy() == false)) {
+				st_request_exec_move();				// ran but prepped nothing - don't stall idle steppers
+			}
+		}
+		sps.exec_busy = false;
+	} else {
+		mp_preload_move();							// ring is full - a spare exec
 	}
 }
 
@@ -471,63 +537,73 @@ static void _request_load_move()
 
 void _load_move()
 {
+	stPrepBuffer_t *bf = &sps.bf[sps.load_index];
+
 	if (st.dda_ticks_downcount != 0) return;					// exit if it's still busy
-	if (sps.exec_state != PREP_BUFFER_OWNED_BY_LOADER) return;	// if there are no more moves
+	if (bf->exec_state != PREP_BUFFER_OWNED_BY_LOADER) {		// if there are no more moves
+		// exec was asked for a segment and hasn't delivered it: the steppers stall
+		if ((TIMER_EXEC.CTRLA == STEP_TIMER_ENABLE) || (sps.exec_busy == true)) {
+			sps.underruns++;
+		}
+		st_request_exec_move();									// restart exec (e.g. after a dwell)
+		return;
+	}
 
 	// handle aline loads first (most common case)  NB: there are no more lines, only alines
-	if (sps.move_type == MOVE_TYPE_ALINE) {
-		st.dda_ticks_downcount = sps.dda_ticks;
-		st.dda_ticks_X_substeps = sps.dda_ticks_X_substeps;
-		TIMER_DDA.PER = sps.dda_period;
+	if (bf->move_type == MOVE_TYPE_ALINE) {
+		SIM_LOAD();
+		st.dda_ticks_downcount = bf->dda_ticks;
+		st.dda_ticks_X_substeps = bf->dda_ticks_X_substeps;
+		TIMER_DDA.PER = bf->dda_period;
  
 		// This section is somewhat optimized for execution speed 
 		// All axes must set steps and compensate for out-of-range pulse phasing. 
 		// If axis has 0 steps the direction setting can be omitted
 		// If axis has 0 steps enabling motors is req'd to support power mode = 1
 
-		st.m[MOTOR_1].phase_increment = sps.m[MOTOR_1].phase_increment;			// set steps
-		if (sps.reset_flag == true) {				// compensate for pulse phasing
+		st.m[MOTOR_1].phase_increment = bf->m[MOTOR_1].phase_increment;			// set steps
+		if (bf->reset_flag == true) {				// compensate for pulse phasing
 			st.m[MOTOR_1].phase_accumulator = -(st.dda_ticks_downcount);
 		}
 		if (st.m[MOTOR_1].phase_increment != 0) {
 			// For ideal optimizations, only set or clear a bit at a time.
-			if (sps.m[MOTOR_1].dir == 0) {
+			if (bf->m[MOTOR_1].dir == 0) {
 				PORT_MOTOR_1_VPORT.OUT &= ~DIRECTION_BIT_bm;// CW motion (bit cleared)
 			} else {
 				PORT_MOTOR_1_VPORT.OUT |= DIRECTION_BIT_bm;	// CCW motion
 			}
 			PORT_MOTOR_1_VPORT.OUT &= ~MOTOR_ENABLE_BIT_bm;	// enable motor
 		}
-		st.m[MOTOR_2].phase_increment = sps.m[MOTOR_2].phase_increment;
-		if (sps.reset_flag == true) {
+		st.m[MOTOR_2].phase_increment = bf->m[MOTOR_2].phase_increment;
+		if (bf->reset_flag == true) {
 			st.m[MOTOR_2].phase_accumulator = -(st.dda_ticks_downcount);
 		}
 		if (st.m[MOTOR_2].phase_increment != 0) {
-			if (sps.m[MOTOR_2].dir == 0) {
+			if (bf->m[MOTOR_2].dir == 0) {
 				PORT_MOTOR_2_VPORT.OUT &= ~DIRECTION_BIT_bm;
 			} else {
 				PORT_MOTOR_2_VPORT.OUT |= DIRECTION_BIT_bm;
 			}
 			PORT_MOTOR_2_VPORT.OUT &= ~MOTOR_ENABLE_BIT_bm;
 		}
-		st.m[MOTOR_3].phase_increment = sps.m[MOTOR_3].phase_increment;
-		if (sps.reset_flag == true) {
+		st.m[MOTOR_3].phase_increment = bf->m[MOTOR_3].phase_increment;
+		if (bf->reset_flag == true) {
 			st.m[MOTOR_3].phase_accumulator = -(st.dda_ticks_downcount);
 		}
 		if (st.m[MOTOR_3].phase_increment != 0) {
-			if (sps.m[MOTOR_3].dir == 0) {
+			if (bf->m[MOTOR_3].dir == 0) {
 				PORT_MOTOR_3_VPORT.OUT &= ~DIRECTION_BIT_bm;
 			} else {
 				PORT_MOTOR_3_VPORT.OUT |= DIRECTION_BIT_bm;
 			}
 			PORT_MOTOR_3_VPORT.OUT &= ~MOTOR_ENABLE_BIT_bm;
 		}
-		st.m[MOTOR_4].phase_increment = sps.m[MOTOR_4].phase_increment;
-		if (sps.reset_flag == true) {
-			st.m[MOTOR_4].phase_accumulator = (st.dda_ticks_downcount);
+		st.m[MOTOR_4].phase_increment = bf->m[MOTOR_4].phase_increment;
+		if (bf->reset_flag == true) {
+			st.m[MOTOR_4].phase_accumulator = -(st.dda_ticks_downcount);// negated like motors 1-3 (was positive)
 		}
 		if (st.m[MOTOR_4].phase_increment != 0) {
-			if (sps.m[MOTOR_4].dir == 0) {
+			if (bf->m[MOTOR_4].dir == 0) {
 				PORT_MOTOR_4_VPORT.OUT &= ~DIRECTION_BIT_bm;
 			} else {
 				PORT_MOTOR_4_VPORT.OUT |= DIRECTION_BIT_bm;
@@ -537,18 +613,29 @@ void _load_move()
 		TIMER_DDA.CTRLA = STEP_TIMER_ENABLE;				// enable the DDA timer
 
 	// handle dwells
-	} else if (sps.move_type == MOVE_TYPE_DWELL) {
-		if (sps.prep_state == true) {
-			st.dda_ticks_downcount = sps.dda_ticks;
-			TIMER_DWELL.PER = sps.dda_period;					// load dwell timer period
+	} else if (bf->move_type == MOVE_TYPE_DWELL) {
+		if (bf->prep_state == true) {
+			st.dda_ticks_downcount = bf->dda_ticks;
+			TIMER_DWELL.PER = bf->dda_period;					// load dwell timer period
  			TIMER_DWELL.CTRLA = STEP_TIMER_ENABLE;				// enable the dwell timer
 		}
+
+	// fire inline commands now that the segment before them has run
+	} else if (bf->move_type == MOVE_TYPE_INLINE_COMMAND) {
+		bf->cm_func(bf->int_val, bf->dbl_val);
 	}
 
 	// all other cases drop to here (e.g. Null moves after Mcodes skip to here) 
-	sps.exec_state = PREP_BUFFER_OWNED_BY_EXEC;				// flip it back
-	sps.prep_state = false;
+	bf->prep_state = false;
+	bf->exec_state = PREP_BUFFER_OWNED_BY_EXEC;				// flip it back
+	if (++sps.load_index == STEP_PREP_RING_SIZE) { sps.load_index = 0;}
 	st_request_exec_move();									// exec and prep next move
+
+	// a null move (or skipped dwell) started nothing - go on to the next buffer
+	if ((st.dda_ticks_downcount == 0) && 
+		(sps.bf[sps.load_index].exec_state == PREP_BUFFER_OWNED_BY_LOADER)) {
+		_request_load_move();
+	}
 }
 
 /*
@@ -562,39 +649,47 @@ void _load_move()
  *
  * Args:
  *	steps[] are signed relative motion in steps (can be non-integer values)
+ *	motors is a bitmask of the motors that move (bit i for motor i). The others
+ *	  are given no steps and their steps[] are not read
  *	Microseconds - how many microseconds the segment should run 
  */
 
-stat_t st_prep_line(float steps[], float microseconds)
+stat_t st_prep_line(float steps[], uint8_t motors, float microseconds)
 {
+	stPrepBuffer_t *bf = &sps.bf[sps.exec_index];
 	uint8_t i;
 	float f_dda = F_DDA;		// starting point for adjustment
 	float dda_substeps = DDA_SUBSTEPS;
 
 	// *** defensive programming ***
 	// trap conditions that would prevent queueing the line
-	if (sps.exec_state != PREP_BUFFER_OWNED_BY_EXEC) { return (STAT_INTERNAL_ERROR);
+	if (bf->exec_state != PREP_BUFFER_OWNED_BY_EXEC) { return (STAT_INTERNAL_ERROR);
 	} else if (isfinite(microseconds) == false) { return (STAT_MINIMUM_LENGTH_MOVE_ERROR);
 	} else if (microseconds < EPSILON) { return (STAT_MINIMUM_TIME_MOVE_ERROR);
 	}
-	sps.reset_flag = false;		// initialize accumulator reset flag for this move.
+	bf->reset_flag = false;		// initialize accumulator reset flag for this move.
 
 	// setup motor parameters
 	for (i=0; i<MOTORS; i++) {
-		sps.m[i].dir = ((steps[i] < 0) ? 1 : 0) ^ cfg.m[i].polarity;
-		sps.m[i].phase_increment = (uint32_t)fabs(steps[i] * dda_substeps);
+		if ((motors & (1<<i)) == 0) {
+			bf->m[i].phase_increment = 0;		// direction is not set for motors that don't step
+			continue;
+		}
+		bf->m[i].dir = ((steps[i] < 0) ? 1 : 0) ^ cfg.m[i].polarity;
+		bf->m[i].phase_increment = (uint32_t)fabs(steps[i] * dda_substeps);
 	}
-	sps.dda_period = _f_to_period(f_dda);
-	sps.dda_ticks = (uint32_t)((microseconds/1000000) * f_dda);
-	sps.dda_ticks_X_substeps = sps.dda_ticks * dda_substeps;	// see FOOTNOTE
+	bf->dda_period = _f_to_period(f_dda);
+	bf->dda_ticks = (uint32_t)((microseconds/1000000) * f_dda);
+	bf->dda_ticks_X_substeps = bf->dda_ticks * dda_substeps;	// see FOOTNOTE
 
 	// anti-stall measure in case change in velocity between segments is too great 
-	if ((sps.dda_ticks * ACCUMULATOR_RESET_FACTOR) < sps.prev_ticks) {  // NB: uint32_t math
-		sps.reset_flag = true;
+	if ((bf->dda_ticks * ACCUMULATOR_RESET_FACTOR) < sps.prev_ticks) {  // NB: uint32_t math
+		bf->reset_flag = true;
 	}
-	sps.prev_ticks = sps.dda_ticks;
-	sps.move_type = MOVE_TYPE_ALINE;
-	sps.prep_state = true;
+	sps.prev_ticks = bf->dda_ticks;
+	bf->move_type = MOVE_TYPE_ALINE;
+	bf->prep_state = true;
+	SIM_PREP();
 	return (STAT_OK);
 }
 // FOOTNOTE: This expression was previously computed as below but floating 
@@ -609,8 +704,30 @@ stat_t st_prep_line(float steps[], float microseconds)
 
 void st_prep_null()
 {
-	sps.move_type = MOVE_TYPE_NULL;
-	sps.prep_state = true;
+	stPrepBuffer_t *bf = &sps.bf[sps.exec_index];
+
+	bf->move_type = MOVE_TYPE_NULL;
+	bf->prep_state = true;
+}
+
+/* 
+ * st_prep_command() - Add an inline command to the move buffer
+ *
+ *	A null move that the loader fires the command for when it reaches it - once
+ *	the segments prepped ahead of it have run. Used by inline commands (see 
+ *	mp_queue_inline_command()). The callback runs in the loader interrupt, so 
+ *	it must be short: a GPIO bit, a PWM duty cycle, a model variable.
+ */
+
+void st_prep_command(void(*cm_exec)(uint8_t, float), uint8_t int_val, float float_val)
+{
+	stPrepBuffer_t *bf = &sps.bf[sps.exec_index];
+
+	bf->move_type = MOVE_TYPE_INLINE_COMMAND;
+	bf->prep_state = true;
+	bf->cm_func = cm_exec;
+	bf->int_val = int_val;
+	bf->dbl_val = float_val;
 }
 
 /* 
@@ -619,10 +736,12 @@ void st_prep_null()
 
 void st_prep_dwell(float microseconds)
 {
-	sps.move_type = MOVE_TYPE_DWELL;
-	sps.prep_state = true;
-	sps.dda_period = _f_to_period(F_DWELL);
-	sps.dda_ticks = (uint32_t)((microseconds/1000000) * F_DWELL);
+	stPrepBuffer_t *bf = &sps.bf[sps.exec_index];
+
+	bf->move_type = MOVE_TYPE_DWELL;
+	bf->prep_state = true;
+	bf->dda_period = _f_to_period(F_DWELL);
+	bf->dda_ticks = (uint32_t)((microseconds/1000000) * F_DWELL);
 }
 
 /*
@@ -636,6 +755,17 @@ inline uint8_t st_isbusy()
 	return (true);
 }
 
+/*
+ * st_prep_isbusy() - return TRUE if prepared segments are waiting for the loader
+ */
+uint8_t st_prep_isbusy()
+{
+	if (sps.bf[sps.load_index].exec_state == PREP_BUFFER_OWNED_BY_LOADER) {
+		return (true);
+	}
+	return (false);
+}
+
 /* 
  * st_set_polarity() - setter needed by the config system
  */
@@ -82,13 +82,19 @@ void st_set_microsteps(const uint8_t motor, const uint8_t microstep_mode);
 void st_set_power_mode(const uint8_t motor, const uint8_t power_mode);
 
 uint8_t st_test_prep_state(void);
+uint8_t st_prep_isbusy(void);	// return TRUE if segments are waiting in the prep ring
 void st_request_exec_move(void);
+void st_request_exec_preload(void);
+void st_exec_hold(void);		// hold off the exec interrupt (main loop)
+void st_exec_release(void);
 void st_prep_null(void);
+void st_prep_command(void(*cm_exec)(uint8_t, float), uint8_t int_val, float float_val);
 void st_prep_dwell(float microseconds);
-stat_t st_prep_line(float steps[], float microseconds);
+stat_t st_prep_line(float steps[], uint8_t motors, float microseconds);
 
 uint16_t st_get_st_magic(void);
 uint16_t st_get_sps_magic(void);
+uint32_t st_get_prep_underruns(void);
 
 #ifdef __DEBUG
 void st_dump_stepper_state(void);
@@ -142,6 +148,18 @@ void st_dump_stepper_state(void);
  */
 #define ACCUMULATOR_RESET_FACTOR 2	// amount counter range can safely change
 
+/* Prep ring
+ *	The exec stage prepares segments into a small ring that the loader drains.
+ *	Exec runs up to STEP_PREP_RING_SIZE segments ahead of the steppers, so a LO
+ *	interrupt that is held off (serial RX, RTC callbacks) for less than that much 
+ *	motion no longer stalls the DDA. 1 gives the old single prep buffer. Inline
+ *	commands are prepped into the ring too, so they fire when the steppers get
+ *	to them (see st_prep_command()).
+ */
+#ifndef STEP_PREP_RING_SIZE
+#define STEP_PREP_RING_SIZE 4		// segments the exec stage can prepare ahead
+#endif
+
 /* DDA minimum operating frequency
  *	This is the minumum value the DDA time can run with a fixed 32 Mhz 
  *	clock. Anything lower will overflow the 16 bit PERIOD register.
@@ -176,4 +194,22 @@ void st_dump_stepper_state(void);
 #define TIMER_LOAD_INTLVL	TIMER_OVFINTLVL_HI
 #define TIMER_EXEC_INTLVL	TIMER_OVFINTLVL_LO
 
+/* Simulation hooks
+ *	The host simulator (sim/) counts step pulses as the DDA emits them, and
+ *	aline segments as they are prepped and as the loader starts them (it times
+ *	feedholds by them). These compile out of the firmware build.
+ */
+#ifdef __SIMULATION
+void sim_step(const uint8_t motor);			// in sim/sim.c
+void sim_prep(void);
+void sim_load(void);
+#define SIM_STEP(motor) sim_step(motor)
+#define SIM_PREP() sim_prep()
+#define SIM_LOAD() sim_load()
+#else
+#define SIM_STEP(motor)
+#define SIM_PREP()
+#define SIM_LOAD()
+#endif
+
 #endif
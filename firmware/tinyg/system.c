@@ -112,6 +112,10 @@ void sys_get_id(char *id)
 	char printable[33] = {"ABCDEFGHJKLMNPQRSTUVWXYZ23456789"};
 	uint8_t i;
 
+#ifdef __SIMULATION
+	strcpy(id, "SIMULA-TION");				// there is no signature row on the host
+	return;
+#endif
 	NVM_CMD = NVM_CMD_READ_CALIB_ROW_gc; 	// Load NVM Command register to read the calibration row
 
 	for (i=0; i<6; i++) {
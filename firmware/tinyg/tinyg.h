@@ -34,7 +34,7 @@
 
 // NOTE: This header requires <stdio.h> be included previously
 
-#define TINYG_FIRMWARE_BUILD  		380.08	// Fixed bug in very short lines (minimum time errors)
+#define TINYG_FIRMWARE_BUILD  		380.10	// Adaptive segment time ($mx)
 #define TINYG_FIRMWARE_VERSION		0.96	// major version
 #define TINYG_HARDWARE_VERSION		8		// board revision number
 #define TINYG_HARDWARE_VERSION_MAX	8		// get ready for version 8
@@ -46,6 +46,7 @@
 //#define __SUPPRESS_STARTUP_MESSAGES 		// what it says
 //#define __UNIT_TESTS						// master enable for unit tests; uncomment modules in .h files
 //#define __DEBUG							// complies debug functions found in test.c
+//#define __PLANNER_STATS					// compile in planner statistics counters (see planner.h)
 
 // UNIT_TESTS exist for various modules are can be enabled at the end of their .h files
 
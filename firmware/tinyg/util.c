@@ -69,6 +69,17 @@ void copy_axis_vector(float dst[], const float src[])
 	memcpy(dst, src, sizeof(float)*AXES);
 }
 
+void set_unit_vector(float unit[], const float target[], const float position[], const float length)
+{
+	float diff;
+	for (uint8_t i=0; i<AXES; i++) {
+		unit[i] = 0;
+		if (fp_NOT_ZERO(diff = target[i] - position[i])) {
+			unit[i] = diff / length;
+		}
+	}
+}
+
 uint8_t vector_equal(const float a[], const float b[]) 
 {
 	if ((fp_EQ(a[AXIS_X], b[AXIS_X])) &&
@@ -177,7 +188,7 @@ uint8_t isnumber(char c)
 	if (c == '.') { return (true); }
 	if (c == '-') { return (true); }
 	if (c == '+') { return (true); }
-	return (isdigit(c));
+	return (isdigit(c) ? true : false);	// isdigit() only promises non-zero
 }
 
 /* 
@@ -49,6 +49,7 @@ uint16_t compute_checksum(char const *string, const uint16_t length);
 
 void copy_vector(float dst[], const float src[], uint8_t length);
 void copy_axis_vector(float dst[], const float src[]);
+void set_unit_vector(float unit[], const float target[], const float position[], const float length);
 uint8_t vector_equal(const float a[], const float b[]) ;
 float get_axis_vector_length(const float a[], const float b[]);
 float *set_vector(float x, float y, float z, float a, float b, float c);
@@ -76,6 +77,10 @@ float *set_vector_by_axis(float value, uint8_t axis);
 #define avg(a,b) ((a+b)/2)
 #endif
 
+#ifdef __SIMULATION
+#define square(x) ((x)*(x))					// avr-libc math.h provides square(); glibc does not
+#endif
+
 #ifndef EPSILON
 #define EPSILON 	0.00001					// rounding error for floats
 //#define EPSILON 	0.000001				// rounding error for floats
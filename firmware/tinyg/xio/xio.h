@@ -251,6 +251,9 @@ enum xioSignals {
 #define CHAR_FEEDHOLD (char)'!'
 #define CHAR_CYCLE_START (char)'~'
 #define CHAR_QUEUE_FLUSH (char)'%'
+#define CHAR_FEED_OVERRIDE_RESET (char)0x90	// feed rate override back to 100%
+#define CHAR_FEED_OVERRIDE_UP (char)0x91		// feed rate override up a step
+#define CHAR_FEED_OVERRIDE_DOWN (char)0x92	// feed rate override down a step
 //#define CHAR_BOOTLOADER ESC
 
 /* XIO return codes
@@ -166,6 +166,18 @@ ISR(USB_RX_ISR_vect)	//ISR(USARTC0_RXC_vect)	// serial port C0 RX int
 		cm_request_cycle_start();
 		return;
 	}
+	if (c == CHAR_FEED_OVERRIDE_RESET) {		// trap feed override signals
+		cm_request_feed_override(FEED_OVERRIDE_RESET_REQUEST);
+		return;
+	}
+	if (c == CHAR_FEED_OVERRIDE_UP) {
+		cm_request_feed_override(FEED_OVERRIDE_UP_REQUEST);
+		return;
+	}
+	if (c == CHAR_FEED_OVERRIDE_DOWN) {
+		cm_request_feed_override(FEED_OVERRIDE_DOWN_REQUEST);
+		return;
+	}
 	if (USB.flag_xoff) {
 		if (c == XOFF) {						// trap incoming XON/XOFF signals
 			USBu.fc_state_tx = FC_IN_XOFF;